@@ -0,0 +1,534 @@
+/**
+ * @file srcml_bench.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcml-bench, the parser throughput benchmark.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * Measures the throughput of each stage of converting source code to srcML,
+ * on a synthetic corpus or on the source of existing srcML archives, e.g.,
+ * the parser testsuite:
+ *
+ *     srcml-bench --size 4096 --json
+ *     srcml-bench test/parser/testsuite/cpp.xml test/parser/testsuite/java.xml
+ *
+ * With --binary, the srcML is written and read as binary srcML, for comparison
+ * of the output, extract, and transform stages with XML.
+ *
+ * The request stage is the handoff of each source to the parser in a client
+ * ParseRequest, from the pool of recycled requests, or with --no-request-pool,
+ * a new request for each source, for comparison of the allocations.
+ */
+
+#include <srcml.h>
+#include <synthetic_corpus.hpp>
+#include <ParseRequest.hpp>
+#include <libxml/xmlmemory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Allocation counting, for both the C++ allocations and libxml2
+ */
+
+static std::atomic<unsigned long long> allocations(0);
+
+void* operator new(std::size_t size) {
+
+    ++allocations;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+
+    free(p);
+}
+
+static void* counting_malloc(size_t size) {
+
+    ++allocations;
+    return malloc(size);
+}
+
+static void* counting_realloc(void* p, size_t size) {
+
+    ++allocations;
+    return realloc(p, size);
+}
+
+static char* counting_strdup(const char* s) {
+
+    ++allocations;
+    return strdup(s);
+}
+
+namespace {
+
+    // stages of converting source code to srcML
+    enum bench_stage { INPUT, REQUEST, PARSE, OUTPUT, FINALIZE, EXTRACT, TRANSFORM, STAGE_COUNT };
+
+    const char* const STAGE_NAMES[] = { "input", "request", "parse", "output", "finalize", "extract", "transform" };
+
+    typedef std::chrono::steady_clock bench_clock;
+
+    // time and allocations of a stage
+    struct stage_result {
+        double seconds = 0;
+        unsigned long long allocations = 0;
+    };
+
+    // measurements of one run through the corpus
+    struct run_result {
+        stage_result stages[STAGE_COUNT];
+        std::map<std::string, double> language_parse_seconds;
+    };
+
+    // accumulates the time and allocations of a stage
+    class stage_timer {
+    public:
+        stage_timer(stage_result& result) : result(result), start(bench_clock::now()), start_allocations(allocations) {}
+
+        ~stage_timer() {
+
+            result.seconds += std::chrono::duration<double>(bench_clock::now() - start).count();
+            result.allocations += allocations - start_allocations;
+        }
+
+    private:
+        stage_result& result;
+        bench_clock::time_point start;
+        unsigned long long start_allocations;
+    };
+
+    struct bench_options {
+        std::vector<std::string> languages;
+        size_t size = 1024 * 1024;
+        unsigned int seed = 1;
+        int iterations = 3;
+        bool json = false;
+        bool binary = false;
+        bool request_pool = true;
+        std::vector<std::string> archives;
+    };
+
+    void usage(std::ostream& out) {
+
+        out << "Usage: srcml-bench [options] [srcml-archive ...]\n\n"
+            << "Measures the throughput of each stage of converting source code to srcML.\n"
+            << "Without srcML archives, a synthetic corpus is generated for each language.\n"
+            << "With srcML archives, e.g., test/parser/testsuite/*.xml, their source is used.\n\n"
+            << "  -l, --language LANG    synthetic corpus language (C, C++, Java, C#), default all\n"
+            << "  -s, --size KB          size of each synthetic corpus in KB, default 1024\n"
+            << "      --seed N           seed for the synthetic corpus, default 1\n"
+            << "  -n, --iterations N     number of runs, the fastest is reported, default 3\n"
+            << "      --binary           write and read the srcML as binary srcML\n"
+            << "      --no-request-pool  use a new parse request for each source\n"
+            << "      --json             output the results as JSON\n"
+            << "  -h, --help             output this help message\n";
+    }
+
+    // value of an option, either as the next argument or after an '='
+    bool option_value(int argc, char* argv[], int& i, const char* short_name, const char* long_name, std::string& value) {
+
+        std::string arg = argv[i];
+        if (arg == short_name || arg == long_name) {
+            if (i + 1 >= argc) {
+                std::cerr << "srcml-bench: missing value for " << arg << '\n';
+                exit(1);
+            }
+            value = argv[++i];
+            return true;
+        }
+
+        std::string prefix = std::string(long_name) + "=";
+        if (arg.compare(0, prefix.size(), prefix) == 0) {
+            value = arg.substr(prefix.size());
+            return true;
+        }
+
+        return false;
+    }
+
+    bench_options parse_options(int argc, char* argv[]) {
+
+        bench_options options;
+        for (int i = 1; i < argc; ++i) {
+
+            std::string arg = argv[i];
+            std::string value;
+            if (arg == "-h" || arg == "--help") {
+                usage(std::cout);
+                exit(0);
+            } else if (arg == "--json") {
+                options.json = true;
+            } else if (arg == "--binary") {
+                options.binary = true;
+            } else if (arg == "--no-request-pool") {
+                options.request_pool = false;
+            } else if (option_value(argc, argv, i, "-l", "--language", value)) {
+                if (std::find(synthetic_languages().begin(), synthetic_languages().end(), value) == synthetic_languages().end()) {
+                    std::cerr << "srcml-bench: no synthetic corpus for language " << value << '\n';
+                    exit(1);
+                }
+                options.languages.push_back(value);
+            } else if (option_value(argc, argv, i, "-s", "--size", value)) {
+                options.size = (size_t) std::stoul(value) * 1024;
+            } else if (option_value(argc, argv, i, "", "--seed", value)) {
+                options.seed = (unsigned int) std::stoul(value);
+            } else if (option_value(argc, argv, i, "-n", "--iterations", value)) {
+                options.iterations = std::max(std::stoi(value), 1);
+            } else if (!arg.empty() && arg[0] == '-') {
+                std::cerr << "srcml-bench: unknown option " << arg << '\n';
+                usage(std::cerr);
+                exit(1);
+            } else {
+                options.archives.push_back(arg);
+            }
+        }
+
+        if (options.languages.empty())
+            options.languages = synthetic_languages();
+
+        return options;
+    }
+
+    // source of the units in a srcML archive
+    void archive_corpus(const std::string& filename, std::vector<bench_source>& corpus) {
+
+        srcml_archive* archive = srcml_archive_create();
+        if (srcml_archive_read_open_filename(archive, filename.c_str()) != SRCML_STATUS_OK) {
+            std::cerr << "srcml-bench: unable to open srcML archive " << filename << '\n';
+            exit(1);
+        }
+
+        int count = 0;
+        while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+
+            ++count;
+            const char* language = srcml_unit_get_language(unit);
+            if (language) {
+                char* buffer = nullptr;
+                size_t size = 0;
+                srcml_unit_set_src_encoding(unit, "UTF-8");
+                if (srcml_unit_unparse_memory(unit, &buffer, &size) == SRCML_STATUS_OK) {
+
+                    bench_source source;
+                    source.language = language;
+                    source.filename = filename + "#" + std::to_string(count);
+                    source.source.assign(buffer, size);
+                    corpus.push_back(std::move(source));
+                }
+                srcml_memory_free(buffer);
+            }
+
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    // load the corpus, synthetic or from srcML archives
+    std::vector<bench_source> load_corpus(const bench_options& options) {
+
+        std::vector<bench_source> corpus;
+        if (options.archives.empty()) {
+            for (const auto& language : options.languages) {
+                auto language_corpus = synthetic_corpus(language, options.size, options.seed);
+                std::move(language_corpus.begin(), language_corpus.end(), std::back_inserter(corpus));
+            }
+        } else {
+            for (const auto& filename : options.archives)
+                archive_corpus(filename, corpus);
+        }
+
+        return corpus;
+    }
+
+    // one run of converting the corpus to srcML, and querying the result
+    run_result run(const std::vector<bench_source>& corpus, bool binary, bool request_pool) {
+
+        run_result result;
+
+        char* buffer = nullptr;
+        size_t size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_set_src_encoding(archive, "UTF-8");
+        if (binary)
+            srcml_archive_enable_binary(archive);
+        srcml_archive_write_open_memory(archive, &buffer, &size);
+
+        for (const auto& source : corpus) {
+
+            // hand the source over in a parse request, as the client does
+            std::shared_ptr<ParseRequest> request;
+            {
+                stage_timer timer(result.stages[REQUEST]);
+                request = request_pool ? ParseRequest::create() : std::shared_ptr<ParseRequest>(new ParseRequest);
+                request->buffer.assign(source.source.begin(), source.source.end());
+            }
+
+            srcml_unit* unit = srcml_unit_create(archive);
+            srcml_unit_set_language(unit, source.language.c_str());
+            srcml_unit_set_filename(unit, source.filename.c_str());
+
+            auto start = bench_clock::now();
+            {
+                stage_timer timer(result.stages[PARSE]);
+                srcml_unit_parse_memory(unit, request->data(), request->size());
+            }
+            result.language_parse_seconds[source.language] += std::chrono::duration<double>(bench_clock::now() - start).count();
+
+            {
+                stage_timer timer(result.stages[OUTPUT]);
+                srcml_archive_write_unit(archive, unit);
+            }
+
+            srcml_unit_free(unit);
+
+            {
+                stage_timer timer(result.stages[REQUEST]);
+                if (request_pool)
+                    ParseRequest::recycle(request);
+                else
+                    request.reset();
+            }
+        }
+
+        {
+            stage_timer timer(result.stages[FINALIZE]);
+            srcml_archive_close(archive);
+        }
+        srcml_archive_free(archive);
+
+        // extract the source code of all units
+        {
+            stage_timer timer(result.stages[EXTRACT]);
+
+            srcml_archive* iarchive = srcml_archive_create();
+            srcml_archive_read_open_memory(iarchive, buffer, size);
+
+            while (srcml_unit* unit = srcml_archive_read_unit(iarchive)) {
+                char* src = nullptr;
+                size_t src_size = 0;
+                srcml_unit_unparse_memory(unit, &src, &src_size);
+                srcml_memory_free(src);
+                srcml_unit_free(unit);
+            }
+
+            srcml_archive_close(iarchive);
+            srcml_archive_free(iarchive);
+        }
+
+        // query the srcML for all functions
+        {
+            stage_timer timer(result.stages[TRANSFORM]);
+
+            srcml_archive* iarchive = srcml_archive_create();
+            srcml_archive_read_open_memory(iarchive, buffer, size);
+            srcml_append_transform_xpath(iarchive, "//src:function");
+
+            while (srcml_unit* unit = srcml_archive_read_unit(iarchive)) {
+                srcml_transform_result* transform_result = nullptr;
+                srcml_unit_apply_transforms(iarchive, unit, &transform_result);
+                srcml_transform_free(transform_result);
+                srcml_unit_free(unit);
+            }
+
+            srcml_archive_close(iarchive);
+            srcml_archive_free(iarchive);
+        }
+
+        srcml_memory_free(buffer);
+
+        return result;
+    }
+
+    // JSON string, with escapes
+    std::string json_string(const std::string& s) {
+
+        std::ostringstream out;
+        out << '"';
+        for (unsigned char c : s) {
+            if (c == '"' || c == '\\')
+                out << '\\' << c;
+            else if (c < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec << std::setfill(' ');
+            else
+                out << c;
+        }
+        out << '"';
+
+        return out.str();
+    }
+
+    double per_second(double amount, double seconds) {
+
+        return seconds > 0 ? amount / seconds : 0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    // count libxml2 allocations, before any use of libxml2
+    xmlMemSetup(free, counting_malloc, counting_realloc, counting_strdup);
+
+    bench_options options = parse_options(argc, argv);
+
+    run_result best;
+    {
+        // the input stage is the creation of the corpus
+        auto start = bench_clock::now();
+        auto start_allocations = allocations.load();
+
+        std::vector<bench_source> corpus = load_corpus(options);
+
+        best.stages[INPUT].seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        best.stages[INPUT].allocations = allocations - start_allocations;
+
+        if (corpus.empty()) {
+            std::cerr << "srcml-bench: empty corpus\n";
+            return 1;
+        }
+
+        // corpus totals, overall and per language
+        size_t bytes = 0;
+        size_t loc = 0;
+        std::map<std::string, std::pair<size_t, size_t>> language_totals;
+        for (const auto& source : corpus) {
+
+            size_t source_loc = std::count(source.source.begin(), source.source.end(), '\n');
+            if (!source.source.empty() && source.source.back() != '\n')
+                ++source_loc;
+
+            bytes += source.source.size();
+            loc += source_loc;
+            language_totals[source.language].first += source.source.size();
+            language_totals[source.language].second += source_loc;
+        }
+
+        // the fastest of the runs for each stage
+        for (int i = 0; i < options.iterations; ++i) {
+
+            run_result result = run(corpus, options.binary, options.request_pool);
+            for (int stage = REQUEST; stage < STAGE_COUNT; ++stage) {
+                if (i == 0 || result.stages[stage].seconds < best.stages[stage].seconds)
+                    best.stages[stage] = result.stages[stage];
+            }
+            for (const auto& language : result.language_parse_seconds) {
+                if (i == 0 || language.second < best.language_parse_seconds[language.first])
+                    best.language_parse_seconds[language.first] = language.second;
+            }
+        }
+
+        double mb = bytes / (1024.0 * 1024.0);
+        double kloc = loc / 1000.0;
+
+        if (options.json) {
+
+            std::cout << "{\n"
+                      << "  \"version\": " << json_string(srcml_version_string()) << ",\n"
+                      << "  \"corpus\": {\n"
+                      << "    \"source\": " << json_string(options.archives.empty() ? "synthetic" : "archives") << ",\n";
+            if (options.archives.empty())
+                std::cout << "    \"seed\": " << options.seed << ",\n";
+            std::cout << "    \"units\": " << corpus.size() << ",\n"
+                      << "    \"bytes\": " << bytes << ",\n"
+                      << "    \"loc\": " << loc << "\n"
+                      << "  },\n"
+                      << "  \"format\": " << json_string(options.binary ? "binary" : "xml") << ",\n"
+                      << "  \"request_pool\": " << (options.request_pool ? "true" : "false") << ",\n"
+                      << "  \"iterations\": " << options.iterations << ",\n"
+                      << "  \"stages\": {\n";
+            for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+                const auto& result = best.stages[stage];
+                std::cout << "    " << json_string(STAGE_NAMES[stage]) << ": { "
+                          << "\"seconds\": " << result.seconds << ", "
+                          << "\"mb_per_second\": " << per_second(mb, result.seconds) << ", "
+                          << "\"kloc_per_second\": " << per_second(kloc, result.seconds) << ", "
+                          << "\"allocations\": " << result.allocations << ", "
+                          << "\"allocations_per_kloc\": " << (kloc > 0 ? result.allocations / kloc : 0) << " }"
+                          << (stage + 1 < STAGE_COUNT ? ",\n" : "\n");
+            }
+            std::cout << "  },\n"
+                      << "  \"languages\": {\n";
+            for (auto it = language_totals.begin(); it != language_totals.end(); ++it) {
+                double seconds = best.language_parse_seconds[it->first];
+                std::cout << "    " << json_string(it->first) << ": { "
+                          << "\"bytes\": " << it->second.first << ", "
+                          << "\"loc\": " << it->second.second << ", "
+                          << "\"parse_seconds\": " << seconds << ", "
+                          << "\"mb_per_second\": " << per_second(it->second.first / (1024.0 * 1024.0), seconds) << ", "
+                          << "\"kloc_per_second\": " << per_second(it->second.second / 1000.0, seconds) << " }"
+                          << (std::next(it) != language_totals.end() ? ",\n" : "\n");
+            }
+            std::cout << "  }\n"
+                      << "}\n";
+
+        } else {
+
+            std::cout << "srcml-bench " << srcml_version_string() << '\n'
+                      << "Corpus: " << (options.archives.empty() ? "synthetic" : "archives") << ", "
+                      << corpus.size() << " units, " << std::fixed << std::setprecision(2) << mb << " MB, "
+                      << std::setprecision(1) << kloc << " KLOC\n"
+                      << "Format: " << (options.binary ? "binary" : "xml") << '\n'
+                      << "Request pool: " << (options.request_pool ? "yes" : "no") << '\n'
+                      << "Fastest of " << options.iterations << " runs\n\n";
+
+            std::cout << std::left << std::setw(12) << "Stage" << std::right
+                      << std::setw(12) << "Seconds" << std::setw(12) << "MB/s"
+                      << std::setw(12) << "KLOC/s" << std::setw(16) << "Allocs/KLOC" << '\n';
+            for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+                const auto& result = best.stages[stage];
+                std::cout << std::left << std::setw(12) << STAGE_NAMES[stage] << std::right
+                          << std::setw(12) << std::setprecision(4) << result.seconds
+                          << std::setw(12) << std::setprecision(2) << per_second(mb, result.seconds)
+                          << std::setw(12) << std::setprecision(1) << per_second(kloc, result.seconds)
+                          << std::setw(16) << std::setprecision(1) << (kloc > 0 ? result.allocations / kloc : 0) << '\n';
+            }
+
+            std::cout << '\n' << std::left << std::setw(12) << "Language" << std::right
+                      << std::setw(12) << "Parse s" << std::setw(12) << "MB/s" << std::setw(12) << "KLOC/s" << '\n';
+            for (const auto& language : language_totals) {
+                double seconds = best.language_parse_seconds[language.first];
+                std::cout << std::left << std::setw(12) << language.first << std::right
+                          << std::setw(12) << std::setprecision(4) << seconds
+                          << std::setw(12) << std::setprecision(2) << per_second(language.second.first / (1024.0 * 1024.0), seconds)
+                          << std::setw(12) << std::setprecision(1) << per_second(language.second.second / 1000.0, seconds) << '\n';
+            }
+        }
+    }
+
+    srcml_cleanup_globals();
+
+    return 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * @file synthetic_corpus.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcml-bench, the parser throughput benchmark.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * Generates source code that exercises the common parts of each grammar:
+ * declarations, expressions, calls, control flow, comments, and the
+ * language-specific wrappers (namespaces, classes, imports).
+ */
+
+#include <synthetic_corpus.hpp>
+#include <random>
+
+namespace {
+
+    // approximate size of each generated file
+    const size_t UNIT_SIZE = 8 * 1024;
+
+    // deepest nesting of generated blocks
+    const int MAX_DEPTH = 3;
+
+    const char* const NAMES[] = { "count", "total", "index", "value", "result", "offset", "length", "node",
+                                  "buffer", "limit", "first", "last", "status", "current", "next", "item" };
+
+    const char* const FUNCTIONS[] = { "update", "compute", "process", "reset", "find", "insert", "remove", "check" };
+
+    const char* const OPERATORS[] = { " + ", " - ", " * ", " / ", " % ", " << ", " & ", " | " };
+
+    const char* const COMPARISONS[] = { " < ", " <= ", " > ", " >= ", " == ", " != " };
+
+    /*
+     * Language-specific parts of the generated source
+     */
+    struct language_syntax {
+        const char* language;
+        const char* extension;
+        std::vector<std::string> types;
+        const char* string_type;
+        const char* header;
+        const char* open_wrapper;
+        const char* close_wrapper;
+        const char* method_prefix;
+        const char* foreach_format;
+        bool has_try;
+        int indent;
+    };
+
+    const std::vector<language_syntax>& syntaxes() {
+
+        static const std::vector<language_syntax> all = {
+            { "C", ".c", { "int", "long", "double", "unsigned int", "char*", "struct node*" }, "const char*",
+              "#include <stdio.h>\n#include <stdlib.h>\n#include \"node.h\"\n\n#define BENCH_LIMIT 64\n\n",
+              "", "", "static ", nullptr, false, 0 },
+            { "C++", ".cpp", { "int", "long", "double", "auto", "std::size_t", "std::vector<int>", "std::map<std::string, int>" }, "std::string",
+              "#include <string>\n#include <vector>\n#include <map>\n\n",
+              "namespace bench {\n\nclass %s {\npublic:\n", "};\n\n}\n", "", "for (const auto& %s : %s)", true, 1 },
+            { "Java", ".java", { "int", "long", "double", "Integer", "List<Integer>", "Map<String, Integer>" }, "String",
+              "package bench;\n\nimport java.util.List;\nimport java.util.Map;\n\n",
+              "public class %s {\n", "}\n", "public ", "for (Integer %s : %s)", true, 1 },
+            { "C#", ".cs", { "int", "long", "double", "var", "List<int>", "Dictionary<string, int>" }, "string",
+              "using System;\nusing System.Collections.Generic;\n\n",
+              "namespace Bench {\n\npublic class %s {\n", "}\n\n}\n", "public ", "foreach (var %s in %s)", true, 1 },
+        };
+
+        return all;
+    }
+
+    /*
+     * Generator of one synthetic file
+     */
+    class source_generator {
+    public:
+        source_generator(const language_syntax& syntax, std::mt19937& random)
+            : syntax(syntax), random(random) {}
+
+        std::string file(const std::string& name) {
+
+            out.clear();
+            out += "/*\n * ";
+            out += name;
+            out += syntax.extension;
+            out += "\n *\n * Generated by srcml-bench\n */\n\n";
+            out += syntax.header;
+
+            if (*syntax.open_wrapper)
+                out += format(syntax.open_wrapper, name);
+
+            int method = 0;
+            while (out.size() < UNIT_SIZE)
+                function(method++);
+
+            out += syntax.close_wrapper;
+
+            return out;
+        }
+
+    private:
+
+        // random number in [0, n)
+        int pick(int n) { return (int) (random() % (unsigned int) n); }
+
+        template <typename T, size_t N>
+        const char* pick(T (&choices)[N]) { return choices[pick((int) N)]; }
+
+        std::string name() {
+
+            std::string s = pick(NAMES);
+            if (pick(3) == 0)
+                s += std::to_string(pick(10));
+            return s;
+        }
+
+        std::string format(const char* pattern, const std::string& first, const std::string& second = "") {
+
+            std::string s;
+            bool used_first = false;
+            for (const char* p = pattern; *p; ++p) {
+                if (p[0] == '%' && p[1] == 's') {
+                    s += used_first ? second : first;
+                    used_first = true;
+                    ++p;
+                } else {
+                    s += *p;
+                }
+            }
+            return s;
+        }
+
+        void indent(int depth) { out.append(4 * (syntax.indent + depth), ' '); }
+
+        std::string operand() {
+
+            switch (pick(6)) {
+            case 0:
+                return std::to_string(pick(1000));
+            case 1:
+                return std::string(pick(FUNCTIONS)) + "(" + name() + ")";
+            case 2:
+                return name() + "[" + name() + "]";
+            default:
+                return name();
+            }
+        }
+
+        std::string expression(int terms = 0) {
+
+            if (terms == 0)
+                terms = 1 + pick(4);
+
+            std::string s = operand();
+            for (int i = 1; i < terms; ++i) {
+                s += pick(OPERATORS);
+                s += pick(5) == 0 ? "(" + expression(2) + ")" : operand();
+            }
+            return s;
+        }
+
+        std::string condition() {
+
+            return expression(1 + pick(2)) + pick(COMPARISONS) + expression(1);
+        }
+
+        void statement(int depth) {
+
+            int kind = pick(depth < MAX_DEPTH ? 12 : 7);
+            indent(depth);
+            switch (kind) {
+            case 0:
+            case 1:
+                out += syntax.types[pick((int) syntax.types.size())] + " " + name() + " = " + expression() + ";\n";
+                break;
+            case 2:
+            case 3:
+                out += name() + " = " + expression() + ";\n";
+                break;
+            case 4:
+                out += std::string(pick(FUNCTIONS)) + "(" + expression(1) + ", " + expression(2) + ");\n";
+                break;
+            case 5:
+                out += std::string(syntax.string_type) + " " + name() + " = \"" + pick(NAMES) + " \\\"" + pick(FUNCTIONS) + "\\\"\";\n";
+                break;
+            case 6:
+                out += "// " + std::string(pick(FUNCTIONS)) + " the " + pick(NAMES) + " before the " + pick(NAMES) + "\n";
+                break;
+            case 7:
+                out += "if (" + condition() + ") {\n";
+                block(depth + 1);
+                indent(depth);
+                if (pick(2)) {
+                    out += "} else {\n";
+                    block(depth + 1);
+                    indent(depth);
+                }
+                out += "}\n";
+                break;
+            case 8:
+                out += "while (" + condition() + ") {\n";
+                block(depth + 1);
+                indent(depth);
+                out += "}\n";
+                break;
+            case 9:
+                {
+                    std::string i = name();
+                    out += "for (int " + i + " = 0; " + i + " < " + name() + "; ++" + i + ") {\n";
+                    block(depth + 1);
+                    indent(depth);
+                    out += "}\n";
+                }
+                break;
+            case 10:
+                if (syntax.foreach_format) {
+                    out += format(syntax.foreach_format, name(), name()) + " {\n";
+                } else {
+                    out += "switch (" + name() + ") {\n";
+                    indent(depth);
+                    out += "case " + std::to_string(pick(10)) + ":\n";
+                }
+                block(depth + 1);
+                indent(depth);
+                out += "}\n";
+                break;
+            default:
+                if (syntax.has_try) {
+                    out += "try {\n";
+                    block(depth + 1);
+                    indent(depth);
+                    out += std::string("} catch (") + (syntax.language == std::string("C++") ? "const std::exception&" : "Exception") + " e) {\n";
+                    block(depth + 1);
+                    indent(depth);
+                    out += "}\n";
+                } else {
+                    out += "do {\n";
+                    block(depth + 1);
+                    indent(depth);
+                    out += "} while (" + condition() + ");\n";
+                }
+                break;
+            }
+        }
+
+        void block(int depth) {
+
+            int statements = 1 + pick(4);
+            for (int i = 0; i < statements; ++i)
+                statement(depth);
+        }
+
+        void function(int number) {
+
+            indent(0);
+            out += "/** " + std::string(pick(FUNCTIONS)) + " the " + pick(NAMES) + " */\n";
+            indent(0);
+            out += syntax.method_prefix;
+            out += syntax.types[pick(3)] + " " + pick(FUNCTIONS) + std::to_string(number) + "(";
+            out += syntax.types[pick(3)] + " " + name() + ", " + syntax.types[pick((int) syntax.types.size())] + " " + name() + ")";
+            out += syntax.indent ? " {\n" : "\n{\n";
+
+            int statements = 5 + pick(10);
+            for (int i = 0; i < statements; ++i)
+                statement(1);
+
+            indent(1);
+            out += "return " + expression(2) + ";\n";
+            indent(0);
+            out += "}\n\n";
+        }
+
+        const language_syntax& syntax;
+        std::mt19937& random;
+        std::string out;
+    };
+}
+
+// languages with a synthetic corpus
+const std::vector<std::string>& synthetic_languages() {
+
+    static std::vector<std::string> languages;
+    if (languages.empty())
+        for (const auto& syntax : syntaxes())
+            languages.push_back(syntax.language);
+
+    return languages;
+}
+
+// Generate a synthetic corpus of about size bytes of source code in the language
+std::vector<bench_source> synthetic_corpus(const std::string& language, size_t size, unsigned int seed) {
+
+    std::vector<bench_source> corpus;
+
+    for (const auto& syntax : syntaxes()) {
+        if (language != syntax.language)
+            continue;
+
+        // std::mt19937 output is fully specified, so the corpus is the same on all platforms
+        std::mt19937 random(seed);
+        source_generator generator(syntax, random);
+
+        size_t total = 0;
+        for (int i = 1; total < size; ++i) {
+
+            std::string name = "Bench" + std::to_string(i);
+
+            bench_source source;
+            source.language = syntax.language;
+            source.filename = "synthetic/" + name + syntax.extension;
+            source.source = generator.file(name);
+
+            total += source.source.size();
+            corpus.push_back(std::move(source));
+        }
+    }
+
+    return corpus;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file synthetic_corpus.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of srcml-bench, the parser throughput benchmark.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef SYNTHETIC_CORPUS_HPP
+#define SYNTHETIC_CORPUS_HPP
+
+#include <string>
+#include <vector>
+
+// source file of a benchmark corpus
+struct bench_source {
+    std::string language;
+    std::string filename;
+    std::string source;
+};
+
+// languages with a synthetic corpus
+const std::vector<std::string>& synthetic_languages();
+
+// Generate a synthetic corpus of about size bytes of source code in the language.
+// The same language, size, and seed always generate the same corpus.
+std::vector<bench_source> synthetic_corpus(const std::string& language, size_t size, unsigned int seed);
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file ParseQueue.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <ParseQueue.hpp>
+#include <srcml_consume.hpp>
+#include <sys/stat.h>
+
+namespace {
+
+    // pending requests per thread that a worker may start ahead of the oldest
+    const int WINDOW_PER_THREAD = 32;
+
+    // size of the source of a request, from the buffer or the file on disk
+    size_t request_size(const ParseRequest& request) {
+
+        if (request.size() || !request.disk_filename)
+            return request.size();
+
+        struct stat s;
+        if (stat(request.disk_filename->c_str(), &s) != 0)
+            return 0;
+
+        return (size_t) s.st_size;
+    }
+}
+
+ParseQueue::ParseQueue(int max_threads, WriteQueue* write_queue)
+    : wqueue(write_queue) {
+
+    if (max_threads < 1)
+        max_threads = 1;
+
+    window = WINDOW_PER_THREAD * max_threads;
+
+    for (int i = 0; i < max_threads; ++i)
+        workers.emplace_back(&ParseQueue::process, this, i);
+}
+
+ParseQueue::~ParseQueue() {
+
+    wait();
+}
+
+/* add a request for parsing */
+void ParseQueue::schedule(std::shared_ptr<ParseRequest> pvalue) {
+
+    size_t size = pvalue->status ? 0 : request_size(*pvalue);
+
+    std::unique_lock<std::mutex> lock(e);
+
+    pvalue->position = ++counter;
+
+    // error passthrough to output for proper output in trace
+    if (pvalue->status) {
+        lock.unlock();
+        pvalue->unit = 0;
+        wqueue->schedule(pvalue);
+        return;
+    }
+
+    pending[pvalue->position] = std::make_pair(size, pvalue);
+    by_size.insert(std::make_pair(size, pvalue->position));
+
+    lock.unlock();
+    cv.notify_one();
+}
+
+/* wait for all requests to be parsed */
+void ParseQueue::wait() {
+
+    {
+        std::lock_guard<std::mutex> lock(e);
+
+        completed = true;
+    }
+
+    cv.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    workers.clear();
+}
+
+/* next request to parse, with the lock held */
+std::shared_ptr<ParseRequest> ParseQueue::next() {
+
+    // the oldest request has fallen too far behind, and is holding up the output
+    int oldest = pending.begin()->first;
+    int position = max_started - oldest >= window ? oldest : by_size.begin()->second;
+
+    auto it = pending.find(position);
+    std::shared_ptr<ParseRequest> request = it->second.second;
+    by_size.erase(std::make_pair(it->second.first, position));
+    pending.erase(it);
+
+    if (position > max_started)
+        max_started = position;
+
+    return request;
+}
+
+/* parse requests until the queue is finished */
+void ParseQueue::process(int thread_id) {
+
+    while (true) {
+
+        std::shared_ptr<ParseRequest> request;
+        {
+            std::unique_lock<std::mutex> lock(e);
+
+            cv.wait(lock, [this]() { return !pending.empty() || completed; });
+            if (pending.empty())
+                return;
+
+            request = next();
+        }
+
+        srcml_consume(thread_id, request, wqueue);
+    }
+}
@@ -25,48 +25,62 @@
 
 #include <ParseRequest.hpp>
 #include <WriteQueue.hpp>
-#include <ctpl_stl.h>
 #include <mutex>
-#include <srcml_consume.hpp>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <set>
+#include <map>
 #include <memory>
 #include <srcml_utilities.hpp>
 
+/*
+ * Queue of requests for parsing by a set of worker threads.
+ *
+ * Workers take the largest pending request first, so that a large file does
+ * not start at the end and leave the run waiting on a single thread. Since
+ * output is in position order, a worker takes the oldest pending request instead
+ * when it has fallen too far behind, which bounds the parsed units waiting
+ * in the WriteQueue.
+ */
 class ParseQueue {
 public:
 
-    ParseQueue(int max_threads, WriteQueue* write_queue)
-        : pool(max_threads), wqueue(write_queue) {}
+    ParseQueue(int max_threads, WriteQueue* write_queue);
 
-    inline void schedule(std::shared_ptr<ParseRequest> pvalue) {
+    ~ParseQueue();
 
-        int next;
-        {
-            std::unique_lock<std::mutex> l(e);
+    // add a request for parsing
+    void schedule(std::shared_ptr<ParseRequest> pvalue);
 
-            next = ++counter;
-        }
-        pvalue->position = next;
+    // wait for all requests to be parsed
+    void wait();
 
-        // error passthrough to output for proper output in trace
-        if (pvalue->status) {
-            pvalue->unit = 0;
-            wqueue->schedule(pvalue);
-            return;
-        }
+private:
 
-        pool.push(srcml_consume, pvalue, wqueue);
-    }
+    // parse requests until the queue is finished
+    void process(int thread_id);
 
-    inline void wait() {
+    // next request to parse, with the lock held
+    std::shared_ptr<ParseRequest> next();
 
-        pool.stop(true);
-    }
+    // ordering of pending requests, largest first, then by position
+    struct larger {
+        bool operator()(const std::pair<size_t, int>& r1, const std::pair<size_t, int>& r2) const {
+            return r1.first != r2.first ? r1.first > r2.first : r1.second < r2.second;
+        }
+    };
 
-private:
-    ctpl::thread_pool pool;
     WriteQueue* wqueue;
+    std::vector<std::thread> workers;
+    std::map<int, std::pair<size_t, std::shared_ptr<ParseRequest>>> pending;
+    std::set<std::pair<size_t, int>, larger> by_size;
+    int window;
     int counter = 0;
+    int max_started = 0;
+    bool completed = false;
     std::mutex e;
+    std::condition_variable cv;
 };
 
 #endif
@@ -0,0 +1,85 @@
+/**
+ * @file ParseRequest.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <ParseRequest.hpp>
+#include <mutex>
+
+namespace {
+
+    // most requests kept in the pool
+    const size_t MAX_POOLED = 256;
+
+    // largest buffer capacity kept by a pooled request, so a large file does not hold on to its memory
+    const size_t MAX_POOLED_CAPACITY = 1024 * 1024;
+
+    // most buffer memory kept by all pooled requests together
+    const size_t MAX_POOLED_BYTES = 16 * 1024 * 1024;
+
+    std::mutex pool_mutex;
+    std::vector<std::shared_ptr<ParseRequest>> pool;
+    size_t pooled_bytes = 0;
+}
+
+std::shared_ptr<ParseRequest> ParseRequest::create() {
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!pool.empty()) {
+            std::shared_ptr<ParseRequest> request(std::move(pool.back()));
+            pool.pop_back();
+            pooled_bytes -= request->buffer.capacity();
+            return request;
+        }
+    }
+
+    return std::make_shared<ParseRequest>();
+}
+
+void ParseRequest::recycle(std::shared_ptr<ParseRequest>& request) {
+
+    // still in use by someone else
+    if (!request || request.use_count() != 1) {
+        request.reset();
+        return;
+    }
+
+    // reset all fields, except for the buffer memory
+    std::vector<char> buffer;
+    if (request->buffer.capacity() <= MAX_POOLED_CAPACITY) {
+        buffer.swap(request->buffer);
+        buffer.clear();
+    }
+    *request = ParseRequest();
+    request->buffer.swap(buffer);
+
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (pool.size() < MAX_POOLED) {
+
+        // over the memory of the pool, so the request is kept without its buffer
+        if (pooled_bytes + request->buffer.capacity() > MAX_POOLED_BYTES)
+            std::vector<char>().swap(request->buffer);
+
+        pooled_bytes += request->buffer.capacity();
+        pool.push_back(std::move(request));
+    }
+    request.reset();
+}
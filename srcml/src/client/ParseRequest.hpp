@@ -33,17 +33,32 @@
 struct ParseRequest {
     ParseRequest(int size = 0) : buffer(size) {}
 
+    // request from the pool of recycled requests, or a new one if none are available
+    static std::shared_ptr<ParseRequest> create();
+
+    // return a request that is no longer used elsewhere to the pool, keeping the capacity of its buffer
+    static void recycle(std::shared_ptr<ParseRequest>& request);
+
+    // source to parse, from the view if there is one
+    const char* data() const { return view ? view.get() : buffer.data(); }
+    size_t size() const { return view ? view_size : buffer.size(); }
+
     // Fields required by thread to process a unit
     std::string language;
     boost::optional<std::string> filename;
     boost::optional<std::string> url;
     boost::optional<std::string> version;
     std::vector<char> buffer;
+    // source used in place, e.g., in a memory-mapped archive, and released once parsed
+    std::shared_ptr<const char> view;
+    size_t view_size = 0;
     srcml_archive* srcml_arch = nullptr;
     std::unique_ptr<srcml_unit> unit;
     boost::optional<std::string> disk_filename;
     boost::optional<std::string> disk_dir;
     std::string parsertest_filename;
+    std::string parsertest_srcml;
+    std::string parsertest_result;
     int position = 0;
     int status = 0;
     double runtime = 0;
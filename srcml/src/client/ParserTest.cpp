@@ -37,6 +37,31 @@
 
 #define str2arg(s) s, (int) strlen(s)
 
+void ParserTest::reparse(ParseRequest* request) {
+
+    srcml_unit* unit = request->unit.get();
+
+    // get the src
+    char* buffer = nullptr;
+    size_t size = 0;
+    srcml_unit_set_src_encoding(unit, "UTF-8");
+    srcml_unit_unparse_memory(unit, &buffer, &size);
+
+    // get the srcml
+    if (srcml_unit_get_srcml_inner(unit))
+        request->parsertest_srcml = srcml_unit_get_srcml_inner(unit);
+
+    std::unique_ptr<srcml_unit> outunit(srcml_unit_clone(unit));
+    srcml_unit_set_language(outunit.get(), srcml_unit_get_language(unit));
+
+    srcml_unit_parse_memory(outunit.get(), buffer, size);
+
+    if (srcml_unit_get_srcml_inner(outunit.get()))
+        request->parsertest_result = srcml_unit_get_srcml_inner(outunit.get());
+
+    free(buffer);
+}
+
 void ParserTest::entry(const ParseRequest* request, srcml_archive* archive, srcml_unit* unit) {
 
     bool color = !(SRCMLOptions::get() & SRCML_COMMAND_NO_COLOR);
@@ -69,25 +94,9 @@ void ParserTest::entry(const ParseRequest* request, srcml_archive* archive, srcm
 
     ++ltotal[unit_language];
 
-    // get the src
-    char* buffer = nullptr;
-    size_t size = 0;
-    srcml_unit_set_src_encoding(unit, "UTF-8");
-    srcml_unit_unparse_memory(unit, &buffer, &size);
-
-    // get the srcml
-    std::string sxml;
-    if (srcml_unit_get_srcml_inner(unit))
-        sxml = srcml_unit_get_srcml_inner(unit);
-
-    std::unique_ptr<srcml_unit> outunit(srcml_unit_clone(unit));
-    srcml_unit_set_language(outunit.get(), srcml_unit_get_language(unit));
-
-    srcml_unit_parse_memory(outunit.get(), buffer, size);
-
-    std::string ssout;
-    if (srcml_unit_get_srcml_inner(outunit.get()))
-        ssout = srcml_unit_get_srcml_inner(outunit.get());
+    // srcml of the test case and from parsing its source, from reparse()
+    std::string sxml = request->parsertest_srcml;
+    std::string ssout = request->parsertest_result;
 
     if (line_count >= 75) {
         std::ostringstream sout;
@@ -171,8 +180,6 @@ void ParserTest::entry(const ParseRequest* request, srcml_archive* archive, srcm
         summary.push_back(summary_report.str());
     }
     srcml_archive_write_string(archive, " ", 1);
-
-    free(buffer);
 }
 
 void ParserTest::report(srcml_archive* archive) {
@@ -38,6 +38,9 @@ public:
 
     ParserTest() { line_count = 0; count = 0; total = 0; failed = 0; }
 
+    // reparse the source of the unit, run in the parsing threads
+    static void reparse(ParseRequest* request);
+
     static void entry(const ParseRequest* request, srcml_archive* archive, srcml_unit* unit);
 
     static void report(srcml_archive* archive);
@@ -26,7 +26,7 @@
 #include <iomanip>
 #include <iostream>
 
-size_t TraceLog::loc = 0;
+std::atomic<size_t> TraceLog::loc(0);
 
 TraceLog::TraceLog()
     : enabled(option(SRCML_COMMAND_VERBOSE)) {
@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <string>
+#include <atomic>
 
 class TraceLog {
 public:
@@ -54,7 +55,7 @@ private:
     int count = 0;
     int num_skipped = 0;
     int num_error = 0;
-    static size_t loc;
+    static std::atomic<size_t> loc;
 };
 
 #endif
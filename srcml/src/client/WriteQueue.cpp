@@ -22,13 +22,39 @@
 
 #include <WriteQueue.hpp>
 #include <srcml_write.hpp>
+#include <srcml_cli.hpp>
+#include <srcml_options.hpp>
+#include <SRCMLStatus.hpp>
 
-WriteQueue::WriteQueue(TraceLog& log, const srcml_output_dest& destination, bool ordered)
+namespace {
+
+    // whether the request is written to its own file, with nothing shared with the other requests
+    bool separate_write(const ParseRequest& request) {
+
+        return option(SRCML_COMMAND_NOARCHIVE) && !option(SRCML_COMMAND_VERBOSE) && !option(SRCML_COMMAND_PARSER_TEST) &&
+               !option(SRCML_COMMAND_CAT_XML) && request.unit && !request.results && request.status == SRCML_STATUS_OK;
+    }
+
+    // whether the requests are written to the same file
+    bool same_file(const ParseRequest& request, const ParseRequest& other) {
+
+        return request.filename == other.filename && request.disk_dir == other.disk_dir;
+    }
+}
+
+WriteQueue::WriteQueue(TraceLog& log, const srcml_output_dest& destination, bool ordered, int max_threads)
        : log(log), destination(destination), ordered(ordered), maxposition(0), q(
             [](std::shared_ptr<ParseRequest> r1, std::shared_ptr<ParseRequest> r2) {
                 return r1->position > r2->position;
             }) {
 
+    // each unit to its own file, so files are created concurrently.
+    // The number of open files is still bounded by the OpenFileLimiter
+    if (max_threads > 1 && option(SRCML_COMMAND_NOARCHIVE)) {
+        writers.reset(new ctpl::thread_pool(max_threads));
+        max_pending = 4 * (size_t) max_threads;
+    }
+
     write_thread = std::thread(&WriteQueue::process, this);
 }
 
@@ -64,6 +90,32 @@ void WriteQueue::stop() {
     write_thread.join();
 }
 
+// wait for a write to a separate file, and report if it failed
+void WriteQueue::wait_write(pending_write& write) {
+
+    // already waited for, as an earlier unit of the same file
+    if (!write.done.valid())
+        return;
+
+    try {
+        write.done.get();
+    } catch (const std::exception& e) {
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to write %s: %s", write.request->filename ? *write.request->filename : "unit", e.what());
+    } catch (...) {
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to write %s", write.request->filename ? *write.request->filename : "unit");
+    }
+}
+
+// wait for the oldest write to a separate file
+void WriteQueue::finish_write() {
+
+    wait_write(pending.front());
+
+    // reuse the request and its buffer for another file
+    ParseRequest::recycle(pending.front().request);
+    pending.pop_front();
+}
+
 void WriteQueue::process() {
 
     int position = 0;
@@ -75,8 +127,14 @@ void WriteQueue::process() {
             std::unique_lock<std::mutex> lock(qmutex);
 
             while (q.empty() || (ordered && (q.top()->position != position + 1))) {
-                if (q.empty() && completed)
+                if (q.empty() && completed) {
+                    lock.unlock();
+
+                    // finish all writes to separate files
+                    while (!pending.empty())
+                        finish_write();
                     return;
+                }
                 cv.wait(lock);
             }
 
@@ -89,7 +147,30 @@ void WriteQueue::process() {
         if (pvalue->status == SRCML_STATUS_OK)
             ++total;
 
+        // write to a separate file on another thread
+        if (writers && separate_write(*pvalue)) {
+
+            // a repeated filename has to wait for the earlier unit, so that the last unit wins
+            for (auto& write : pending) {
+                if (same_file(*write.request, *pvalue))
+                    wait_write(write);
+            }
+
+            pending.push_back({ pvalue, writers->push([this, pvalue](int) {
+                srcml_write_request(pvalue, log, destination);
+            }) });
+            pvalue.reset();
+
+            if (pending.size() >= max_pending)
+                finish_write();
+
+            continue;
+        }
+
         // finally write it out
         srcml_write_request(pvalue, log, destination);
+
+        // reuse the request and its buffer for another file
+        ParseRequest::recycle(pvalue);
     }
 }
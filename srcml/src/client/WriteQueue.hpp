@@ -32,11 +32,13 @@
 #include <thread>
 #include <TraceLog.hpp>
 #include <srcml_input_src.hpp>
+#include <ctpl_stl.h>
+#include <future>
 
 class WriteQueue {
 
 public:
-    WriteQueue(TraceLog& log, const srcml_output_dest& destination, bool ordered = true);
+    WriteQueue(TraceLog& log, const srcml_output_dest& destination, bool ordered = true, int max_threads = 1);
 
     // writes out the current srcml
     void schedule(std::shared_ptr<ParseRequest> pvalue);
@@ -47,6 +49,7 @@ public:
     // actual process
     void process();
 
+
     // number of units writtent
     int numWritten() const { return total; }
 
@@ -61,6 +64,23 @@ public:
     std::condition_variable cv;
     int total = 0;
     bool completed = false;
+
+    // writers of units to separate files, when there is more than one thread
+    std::unique_ptr<ctpl::thread_pool> writers;
+
+    /** write to a separate file in progress */
+    struct pending_write {
+        std::shared_ptr<ParseRequest> request;
+        std::future<void> done;
+    };
+    std::deque<pending_write> pending;
+    size_t max_pending = 0;
+
+    // wait for a write to a separate file, and report if it failed
+    void wait_write(pending_write& write);
+
+    // wait for the oldest write to a separate file
+    void finish_write();
 };
 
 #endif
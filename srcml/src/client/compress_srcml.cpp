@@ -25,13 +25,44 @@
 #include <archive_entry.h>
 #include <SRCMLStatus.hpp>
 #include <libarchive_utilities.hpp>
+#include <srcml_channel.hpp>
+#include <parallel_compressor.hpp>
 #include <memory>
 
 #if ARCHIVE_VERSION_NUMBER >= 3002000
-void compress_srcml(const srcml_request_t& /* srcml_request */,
+void compress_srcml(const srcml_request_t& srcml_request,
                     const srcml_input_t& input_sources,
                     const srcml_output_dest& destination) {
 
+    // compress in independent blocks on multiple threads, only when requested
+    int threads = srcml_request.compression_threads;
+    if (threads > 1 && parallel_compressor::supports(destination.compressions)) {
+
+        parallel_compressor compressor(destination, threads);
+
+        if (input_sources[0].channel) {
+            std::vector<char> buffer;
+            while (input_sources[0].channel->read_buffer(buffer)) {
+                if (!compressor.write(buffer.data(), buffer.size()))
+                    break;
+            }
+            input_sources[0].channel->close_read();
+        } else {
+            std::vector<char> buffer(4 * 1024 * 1024);
+            while (true) {
+                ssize_t s = read(*input_sources[0].fd, buffer.data(), (size_t) buffer.size());
+                if (s <= 0)
+                    break;
+
+                if (!compressor.write(buffer.data(), (size_t) s))
+                    break;
+            }
+        }
+
+        compressor.close();
+        return;
+    }
+
     // create a new archive for output that will handle all
     // types, including source-code files
     std::unique_ptr<archive> ar(archive_write_new());
@@ -73,7 +104,18 @@ void compress_srcml(const srcml_request_t& /* srcml_request */,
         exit(1);
     }
 
-    // write the data into the archive
+    // write the data into the archive, taking each buffer from an in-memory channel as is
+    if (input_sources[0].channel) {
+        std::vector<char> buffer;
+        while (input_sources[0].channel->read_buffer(buffer)) {
+            ssize_t status = archive_write_data(ar.get(), buffer.data(), buffer.size());
+            if (status == 0)
+                break;
+        }
+        input_sources[0].channel->close_read();
+        return;
+    }
+
     std::vector<char> buffer(4092);
     while (true) {
         ssize_t s = read(*input_sources[0].fd, buffer.data(), (size_t) buffer.size());
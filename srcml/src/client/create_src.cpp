@@ -31,6 +31,7 @@
 #include <SRCMLStatus.hpp>
 #include <libarchive_utilities.hpp>
 #include <srcml_utilities.hpp>
+#include <parallel_compressor.hpp>
 
 static std::unique_ptr<srcml_archive> srcml_read_open_internal(const srcml_input_src& input_source, const boost::optional<size_t>& revision) {
 
@@ -99,7 +100,7 @@ void create_src(const srcml_request_t& srcml_request,
         for (const auto& input_source : input_sources) {
             auto arch(srcml_read_open_internal(input_source, srcml_request.revision));
 
-            src_output_filesystem(arch.get(), destination, log);
+            src_output_filesystem(arch.get(), destination, log, srcml_request.max_threads);
         }
 
     } else if (input_sources.size() == 1 && contains<int>(destination) &&
@@ -110,11 +111,9 @@ void create_src(const srcml_request_t& srcml_request,
         auto arch(srcml_read_open_internal(input_sources[0], srcml_request.revision));
 
         // move to the correct unit
-        for (int i = 1; i < srcml_request.unit; ++i) {
-            if (!srcml_archive_skip_unit(arch.get())) {
-                SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
-                exit(1);
-            }
+        if (!srcml_archive_skip_to_unit(arch.get(), srcml_request.unit)) {
+            SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
+            exit(1);
         }
 
         int count = 0;
@@ -159,11 +158,9 @@ void create_src(const srcml_request_t& srcml_request,
         auto arch(srcml_read_open_internal(input_sources[0], srcml_request.revision));
 
         // move to the correct unit
-        for (int i = 1; i < srcml_request.unit; ++i) {
-            if (!srcml_archive_skip_unit(arch.get())) {
-                SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
-                exit(1);
-            }
+        if (!srcml_archive_skip_to_unit(arch.get(), srcml_request.unit)) {
+            SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_request.unit);
+            exit(1);
         }
 
         std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(arch.get()));
@@ -195,6 +192,13 @@ void create_src(const srcml_request_t& srcml_request,
             exit(1);
         }
 
+        // compress in independent blocks on multiple threads
+        // declared before the archive, since closing the archive closes the compressor
+        std::unique_ptr<parallel_compressor> compressor;
+        int threads = srcml_request.compression_threads;
+        if (threads > 1 && parallel_compressor::supports(destination.compressions))
+            compressor.reset(new parallel_compressor(destination, threads));
+
         std::unique_ptr<archive> ar(archive_write_new());
 
         // setup format
@@ -202,11 +206,15 @@ void create_src(const srcml_request_t& srcml_request,
             archive_write_set_format_by_extension(ar.get(), ext.c_str());
 
         // setup compressions
-        for (const auto& ext : destination.compressions)
-            archive_write_set_compression_by_extension(ar.get(), ext.c_str());
+        if (!compressor) {
+            for (const auto& ext : destination.compressions)
+                archive_write_set_compression_by_extension(ar.get(), ext.c_str());
+        }
 
         int status = ARCHIVE_OK;
-        if (contains<int>(destination)) {
+        if (compressor) {
+            status = archive_write_open(ar.get(), compressor.get(), nullptr, parallel_compressor::write_callback, parallel_compressor::close_callback);
+        } else if (contains<int>(destination)) {
             status = archive_write_open_fd(ar.get(), destination);
         } else {
             status = archive_write_open_filename(ar.get(), destination.resource.c_str());
@@ -222,7 +230,7 @@ void create_src(const srcml_request_t& srcml_request,
             auto arch(srcml_read_open_internal(input_source, srcml_request.revision));
 
             // extract this srcml archive to the source archive
-            src_output_libarchive(arch.get(), ar.get());
+            src_output_libarchive(arch.get(), ar.get(), srcml_request.max_threads);
         }
     }
 }
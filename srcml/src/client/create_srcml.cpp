@@ -42,6 +42,9 @@
 #include <ParserTest.hpp>
 #include <cstring>
 #include <libarchive_utilities.hpp>
+#include <srcml_channel.hpp>
+#include <parallel_decompressor.hpp>
+#include <srcml_pipe.hpp>
 
 int srcml_handler_dispatch(ParseQueue& queue,
                           srcml_archive* srcml_arch,
@@ -96,6 +99,10 @@ int srcml_handler_dispatch(ParseQueue& queue,
         return -1;
     }
 
+    // decompress on multiple threads ahead of libarchive
+    if (parallel_decompressor::supports(uninput))
+        srcml_pipe(uninput, decompress_srcml_parallel);
+
     return src_input_libarchive(queue, srcml_arch, srcml_request, uninput);
 }
 
@@ -114,7 +121,11 @@ void create_srcml(const srcml_request_t& srcml_request,
     // open the output
     int nstatus = SRCML_STATUS_OK;
     if (!option(SRCML_COMMAND_NOARCHIVE)) {
-        if (contains<int>(destination)) {
+        if (destination.channel) {
+
+            nstatus = srcml_archive_write_open_io(srcml_arch.get(), destination.channel.get(), srcml_channel::write_callback, nullptr);
+
+        } else if (contains<int>(destination)) {
 
             nstatus = srcml_archive_write_open_fd(srcml_arch.get(), *destination.fd);
 
@@ -183,6 +194,10 @@ void create_srcml(const srcml_request_t& srcml_request,
             srcml_archive_enable_option(srcml_arch.get(), SRCML_OPTION_NO_XML_DECL);
         if (*srcml_request.markup_options & SRCML_HASH)
             srcml_archive_enable_hash(srcml_arch.get());
+        if (*srcml_request.markup_options & SRCML_INDEX)
+            srcml_archive_enable_index(srcml_arch.get());
+        if (*srcml_request.markup_options & SRCML_BINARY)
+            srcml_archive_enable_binary(srcml_arch.get());
     }
 
     // language
@@ -198,6 +213,10 @@ void create_srcml(const srcml_request_t& srcml_request,
         exit(SRCML_STATUS_INVALID_ARGUMENT);
     }
 
+    // limits on parsing each unit
+    srcml_archive_set_parse_time_limit(srcml_arch.get(), srcml_request.parse_timeout);
+    srcml_archive_set_parse_size_limit(srcml_arch.get(), srcml_request.parse_max_size);
+
     // solo unit when:
     //   only one input
     //   no cli request to make it an archive
@@ -315,8 +334,8 @@ void create_srcml(const srcml_request_t& srcml_request,
     log.output(srcml_archive_get_xml_encoding(srcml_arch.get()));
     log.output("\n");
 
-    // write queue for output of parsing
-    WriteQueue write_queue(log, destination);
+    // write queue for output of parsing, with concurrent writes of units to separate files
+    WriteQueue write_queue(log, destination, true, srcml_request.max_threads);
 
     // parsing queue
     ParseQueue parse_queue(srcml_request.max_threads, &write_queue);
@@ -356,10 +375,20 @@ void create_srcml(const srcml_request_t& srcml_request,
         ParserTest::report(srcml_arch.get());
     }
 
+    // per-stage statistics of parsing and output
+    if (option(SRCML_COMMAND_VERBOSE) && option(SRCML_DEBUG_MODE)) {
+        const char* statistics = srcml_archive_get_statistics(srcml_arch.get());
+        if (statistics && *statistics)
+            SRCMLstatus(DEBUG_MSG) << '\n' << statistics;
+    }
+
     if (status != -1 || always_archive) {
         srcml_archive_close(srcml_arch.get());
     }
 
+    if (destination.channel)
+        destination.channel->close_write();
+
     if (destination.fd)
         close(*destination.fd);
 }
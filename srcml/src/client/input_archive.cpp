@@ -23,12 +23,20 @@
 #include <srcml_pipe.hpp>
 #include <input_archive.hpp>
 #include <unarchive_srcml.hpp>
+#include <parallel_decompressor.hpp>
 
 int input_archive(const srcml_input_src& input) {
 
     srcml_input_src uninput = input;
 
-    if (!input.archives.empty() || !input.compressions.empty()) {
+    // decompress on multiple threads, then unarchive the decompressed input
+    if (parallel_decompressor::supports(input)) {
+
+        srcml_pipe(uninput, decompress_srcml_parallel);
+        if (!input.archives.empty())
+            srcml_pipe(uninput, unarchive_srcml);
+
+    } else if (!input.archives.empty() || !input.compressions.empty()) {
 
         srcml_pipe(uninput, unarchive_srcml);
     }
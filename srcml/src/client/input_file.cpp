@@ -23,10 +23,15 @@
 #include <srcml_pipe.hpp>
 #include <input_file.hpp>
 #include <decompress_srcml.hpp>
+#include <parallel_decompressor.hpp>
 
 void input_file(srcml_input_src& input) {
 
-    if (!input.compressions.empty()) {
+    if (parallel_decompressor::supports(input)) {
+
+        srcml_pipe(input, decompress_srcml_parallel);
+
+    } else if (!input.compressions.empty()) {
 
         srcml_pipe(input, decompress_srcml);
     }
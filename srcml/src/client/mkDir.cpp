@@ -32,12 +32,19 @@ mkDir::mkDir() {
 
 void mkDir::mkdir(const std::string& path) {
 
-    if (last != path) {
-        archive_entry_set_pathname(entry, path.c_str());
-        archive_write_header(arch, entry);
-        archive_write_finish_entry(arch);
-    }
-    last = path;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (created.count(path))
+        return;
+
+    archive_entry_set_pathname(entry, path.c_str());
+    archive_write_header(arch, entry);
+    archive_write_finish_entry(arch);
+
+    // the parent directories now exist as well
+    for (auto pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos + 1))
+        created.insert(path.substr(0, pos));
+    created.insert(path);
 }
 
 mkDir::~mkDir() {
@@ -26,7 +26,17 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <string>
+#include <unordered_set>
+#include <mutex>
 
+/*
+ * mkDir
+ *
+ * Creates directories, including any parent directories. Directories
+ * already created are remembered, so that repeated requests for the
+ * same directory do not make any system calls. Safe to share between
+ * threads.
+ */
 class mkDir {
 public:
     mkDir();
@@ -37,7 +47,8 @@ public:
 private:
     archive* arch;
     archive_entry* entry;
-    std::string last;
+    std::unordered_set<std::string> created;
+    std::mutex mutex;
 };
 
 #endif
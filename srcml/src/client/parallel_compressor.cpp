@@ -0,0 +1,220 @@
+/**
+ * @file parallel_compressor.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <parallel_compressor.hpp>
+#include <src_archive.hpp>
+#include <SRCMLStatus.hpp>
+#include <algorithm>
+
+namespace {
+
+    // append the output of an archive to a string
+    la_ssize_t append_callback(archive*, void* context, const void* buffer, size_t length) {
+
+        ((std::string*) context)->append((const char*) buffer, length);
+
+        return (la_ssize_t) length;
+    }
+
+    // compress a block into a complete, standalone compressed stream, none on failure
+    boost::optional<std::string> compress(const std::string& block, const std::list<std::string>& compressions) {
+
+        std::string result;
+        std::unique_ptr<archive> ar(archive_write_new());
+        if (!ar || archive_write_set_format_raw(ar.get()) != ARCHIVE_OK)
+            return boost::none;
+
+        // a warning is compression through an external program
+        for (const auto& ext : compressions)
+            if (archive_write_set_compression_by_extension(ar.get(), ext.c_str()) < ARCHIVE_WARN)
+                return boost::none;
+
+        // no padding after the compressed data
+        if (archive_write_set_bytes_per_block(ar.get(), 0) != ARCHIVE_OK)
+            return boost::none;
+
+        if (archive_write_open(ar.get(), &result, nullptr, append_callback, nullptr) != ARCHIVE_OK)
+            return boost::none;
+
+        std::unique_ptr<archive_entry> entry(archive_entry_new());
+        if (!entry)
+            return boost::none;
+        archive_entry_set_pathname(entry.get(), "block");
+        archive_entry_set_filetype(entry.get(), AE_IFREG);
+        if (archive_write_header(ar.get(), entry.get()) != ARCHIVE_OK)
+            return boost::none;
+
+        if (archive_write_data(ar.get(), block.data(), block.size()) != (la_ssize_t) block.size())
+            return boost::none;
+
+        // closing flushes the rest of the compressed data into the result
+        if (archive_write_close(ar.get()) != ARCHIVE_OK)
+            return boost::none;
+
+        return result;
+    }
+}
+
+bool parallel_compressor::supports(const std::list<std::string>& compressions) {
+
+    // formats where concatenated streams decompress as a single stream
+    static const char* const concatenable[] = { ".gz", ".bz2", ".xz",
+#if ARCHIVE_VERSION_NUMBER >= 3003003
+        ".zst",
+#endif
+    };
+
+    return compressions.size() == 1 &&
+        std::find(std::begin(concatenable), std::end(concatenable), compressions.front()) != std::end(concatenable);
+}
+
+parallel_compressor::parallel_compressor(const srcml_output_dest& destination, int threads, size_t block_size)
+    : output(archive_write_new()), compressions(destination.compressions), block_size(block_size),
+      max_pending(2 * (size_t) std::max(threads, 1)), pool(std::max(threads, 1)) {
+
+    if (!output) {
+        SRCMLstatus(ERROR_MSG, "Unable to create libarchive archive for compression");
+        exit(1);
+    }
+
+    // the blocks are already compressed
+    archive_write_set_format_raw(output.get());
+
+    int status = ARCHIVE_OK;
+    if (contains<int>(destination)) {
+        status = archive_write_open_fd(output.get(), destination);
+    } else {
+        status = archive_write_open_filename(output.get(), destination.resource.c_str());
+    }
+    if (status != ARCHIVE_OK) {
+        SRCMLstatus(ERROR_MSG, std::to_string(status));
+        exit(1);
+    }
+
+    std::unique_ptr<archive_entry> entry(archive_entry_new());
+    if (!entry) {
+        SRCMLstatus(ERROR_MSG, "Unable to create libarchive entry for compression");
+        exit(1);
+    }
+    archive_entry_set_pathname(entry.get(), "test");
+    archive_entry_set_filetype(entry.get(), AE_IFREG);
+
+    if ((status = archive_write_header(output.get(), entry.get())) != ARCHIVE_OK) {
+        SRCMLstatus(ERROR_MSG, std::to_string(status));
+        exit(1);
+    }
+
+    block.reserve(block_size);
+}
+
+parallel_compressor::~parallel_compressor() {
+
+    close();
+}
+
+bool parallel_compressor::write(const void* data, size_t size) {
+
+    const char* p = (const char*) data;
+    while (size && ok) {
+
+        size_t count = std::min(size, block_size - block.size());
+        block.append(p, count);
+        p += count;
+        size -= count;
+
+        if (block.size() == block_size)
+            compress_block();
+    }
+
+    return ok;
+}
+
+bool parallel_compressor::close() {
+
+    if (closed)
+        return ok;
+    closed = true;
+
+    // an empty stream is still a compressed stream
+    if (!block.empty() || !started)
+        compress_block();
+
+    while (!pending.empty())
+        write_block();
+
+    pool.stop(true);
+
+    if (archive_write_close(output.get()) != ARCHIVE_OK) {
+        if (ok)
+            SRCMLstatus(ERROR_MSG, "srcml: Unable to write compressed output");
+        ok = false;
+    }
+
+    return ok;
+}
+
+// start compression of the current block, writing out the oldest block once enough are in progress
+void parallel_compressor::compress_block() {
+
+    started = true;
+
+    std::shared_ptr<std::string> pblock = std::make_shared<std::string>();
+    pblock->reserve(block_size);
+    pblock->swap(block);
+
+    const auto& blockcompressions = compressions;
+    pending.push_back(pool.push([pblock, blockcompressions](int) { return compress(*pblock, blockcompressions); }));
+
+    if (pending.size() >= max_pending)
+        write_block();
+}
+
+// write the oldest compressed block
+void parallel_compressor::write_block() {
+
+    boost::optional<std::string> compressed = pending.front().get();
+    pending.pop_front();
+
+    if (!ok)
+        return;
+
+    if (!compressed) {
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to compress output");
+        ok = false;
+        return;
+    }
+
+    if (archive_write_data(output.get(), compressed->data(), compressed->size()) != (la_ssize_t) compressed->size()) {
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to write compressed output");
+        ok = false;
+    }
+}
+
+la_ssize_t parallel_compressor::write_callback(archive*, void* context, const void* buffer, size_t length) {
+
+    return ((parallel_compressor*) context)->write(buffer, length) ? (la_ssize_t) length : -1;
+}
+
+int parallel_compressor::close_callback(archive*, void* context) {
+
+    return ((parallel_compressor*) context)->close() ? ARCHIVE_OK : ARCHIVE_FATAL;
+}
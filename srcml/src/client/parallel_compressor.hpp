@@ -0,0 +1,85 @@
+/**
+ * @file parallel_compressor.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef PARALLEL_COMPRESSOR_HPP
+#define PARALLEL_COMPRESSOR_HPP
+
+#include <srcml_input_src.hpp>
+#include <libarchive_utilities.hpp>
+#include <ctpl_stl.h>
+#include <boost/optional.hpp>
+#include <deque>
+#include <future>
+#include <list>
+#include <string>
+
+/*
+ * parallel_compressor
+ *
+ * Compresses a stream in independent blocks on a pool of threads. Each block
+ * is a complete compressed stream (gzip member, bzip2 stream, xz stream, or
+ * zstd frame), and the blocks are written in order to the destination.
+ * Standard decompressors decode the concatenated streams as a single stream.
+ */
+class parallel_compressor {
+public:
+
+    // whether this sequence of compressions can be compressed in blocks
+    static bool supports(const std::list<std::string>& compressions);
+
+    parallel_compressor(const srcml_output_dest& destination, int threads, size_t block_size = 4 * 1024 * 1024);
+    ~parallel_compressor();
+
+    // append data, compressing each block as it fills
+    bool write(const void* data, size_t size);
+
+    // compress the last block, and write out all remaining blocks
+    bool close();
+
+    // callbacks for archive_write_open(), so an archive can be compressed through this
+    static la_ssize_t write_callback(archive*, void* context, const void* buffer, size_t length);
+    static int close_callback(archive*, void* context);
+
+private:
+    void compress_block();
+    void write_block();
+
+    /** raw output of the compressed blocks to the destination */
+    std::unique_ptr<archive> output;
+    std::list<std::string> compressions;
+    size_t block_size;
+    size_t max_pending;
+
+    ctpl::thread_pool pool;
+
+    /** the block being filled */
+    std::string block;
+
+    /** compressed blocks, in order, none if the compression failed */
+    std::deque<std::future<boost::optional<std::string>>> pending;
+
+    bool started = false;
+    bool ok = true;
+    bool closed = false;
+};
+
+#endif
@@ -0,0 +1,351 @@
+/**
+ * @file parallel_decompressor.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <parallel_decompressor.hpp>
+#include <libarchive_utilities.hpp>
+#include <src_prefix.hpp>
+#include <SRCMLStatus.hpp>
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+
+#ifndef _MSC_BUILD
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // bytes needed to recognize the start of a stream
+    const size_t lookahead = 10;
+
+    // size of each read of the input
+    const size_t read_size = 1024 * 1024;
+
+    // once a piece is this many times the piece size, the rest of the input is decompressed as a single stream
+    const size_t max_piece_factor = 4;
+
+    // new libarchive reader of a compressed stream of bytes
+    archive* compressed_reader() {
+
+        archive* ar = archive_read_new();
+        archive_read_support_filter_all(ar);
+        archive_read_support_format_raw(ar);
+        archive_read_support_format_empty(ar);
+
+        return ar;
+    }
+
+    // decompress the data of an opened reader, passing each block of data to write
+    template<typename Write>
+    bool decompress_data(archive* ar, Write write) {
+
+        archive_entry* entry;
+        int status = archive_read_next_header(ar, &entry);
+        if (status == ARCHIVE_EOF)
+            return true;
+        if (status != ARCHIVE_OK)
+            return false;
+
+        std::vector<char> buffer(256 * 1024);
+        while (true) {
+            la_ssize_t size = archive_read_data(ar, buffer.data(), buffer.size());
+            if (size == 0)
+                return true;
+            if (size < 0 || !write(buffer.data(), (size_t) size))
+                return false;
+        }
+    }
+
+    // write all of the data to a file descriptor
+    bool write_all(int fd, const char* data, size_t size) {
+
+        while (size) {
+            auto count = write(fd, data, (unsigned int) size);
+            if (count <= 0)
+                return false;
+
+            data += count;
+            size -= (size_t) count;
+        }
+
+        return true;
+    }
+
+    // input already read, followed by the rest of the file descriptor
+    struct stream_input {
+        std::string head;
+        int fd;
+        std::vector<char> buffer;
+    };
+
+    la_ssize_t stream_read_callback(archive*, void* context, const void** buffer) {
+
+        stream_input* input = (stream_input*) context;
+
+        if (!input->head.empty()) {
+            input->buffer.assign(input->head.begin(), input->head.end());
+            input->head.clear();
+            input->head.shrink_to_fit();
+            *buffer = input->buffer.data();
+            return (la_ssize_t) input->buffer.size();
+        }
+
+        input->buffer.resize(read_size);
+        *buffer = input->buffer.data();
+
+        return (la_ssize_t) read(input->fd, input->buffer.data(), (unsigned int) input->buffer.size());
+    }
+}
+
+bool parallel_decompressor::supports(const srcml_input_src& input) {
+
+    static const char* const concatenable[] = { ".gz", ".bz2", ".xz", ".zst" };
+
+    return input.protocol == "file" && input.compressions.size() == 1 &&
+        std::find(std::begin(concatenable), std::end(concatenable), input.compressions.front()) != std::end(concatenable);
+}
+
+parallel_decompressor::parallel_decompressor(const std::string& compression, int threads, size_t piece_size,
+                                             size_t max_buffered)
+    : compression(compression), piece_size(piece_size), max_pending(2 * (size_t) std::max(threads, 1)),
+      buffered(0), max_buffered(max_buffered), pool(std::max(threads, 1)) {}
+
+// whether the data starts with what looks like the header of a stream of the compression
+bool parallel_decompressor::is_stream_start(const char* data) const {
+
+    const unsigned char* p = (const unsigned char*) data;
+
+    // gzip member: id, deflate, no reserved flags, known extra flags and OS
+    if (compression == ".gz")
+        return p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 0xe0) == 0 &&
+               (p[8] == 0 || p[8] == 2 || p[8] == 4) && (p[9] <= 13 || p[9] == 255);
+
+    // bzip2 stream: "BZh", block size, then the magic of the first block or of the end of stream
+    if (compression == ".bz2")
+        return p[0] == 'B' && p[1] == 'Z' && p[2] == 'h' && p[3] >= '1' && p[3] <= '9' &&
+               ((p[4] == 0x31 && p[5] == 0x41 && p[6] == 0x59 && p[7] == 0x26 && p[8] == 0x53 && p[9] == 0x59) ||
+                (p[4] == 0x17 && p[5] == 0x72 && p[6] == 0x45 && p[7] == 0x38 && p[8] == 0x50 && p[9] == 0x90));
+
+    // xz stream: magic, then the stream flags with a known check type
+    if (compression == ".xz")
+        return p[0] == 0xfd && p[1] == '7' && p[2] == 'z' && p[3] == 'X' && p[4] == 'Z' && p[5] == 0 &&
+               p[6] == 0 && (p[7] == 0 || p[7] == 1 || p[7] == 4 || p[7] == 10);
+
+    // zstd frame: magic, then a frame header descriptor without the reserved bit
+    if (compression == ".zst")
+        return p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd && (p[4] & 0x08) == 0;
+
+    return false;
+}
+
+// decompress a piece of the input, which must be complete streams, within the budget of buffered output
+parallel_decompressor::piece_result parallel_decompressor::decompress_piece(const std::string& data) {
+
+    piece_result result;
+
+    std::unique_ptr<archive> ar(compressed_reader());
+    if (archive_read_open_memory(ar.get(), data.data(), data.size()) != ARCHIVE_OK)
+        return result;
+
+    result.ok = decompress_data(ar.get(), [this, &result](const char* buffer, size_t size) {
+
+        // over the budget, so give up on this piece, and leave it to a single stream
+        if (buffered.fetch_add(size) + size > max_buffered) {
+            buffered -= size + result.output.size();
+            result.output.clear();
+            result.output.shrink_to_fit();
+            result.overflow = true;
+            return false;
+        }
+
+        result.output.append(buffer, size);
+        return true;
+    });
+
+    return result;
+}
+
+// start decompression of a piece, first writing out the oldest pieces while too much is in progress
+void parallel_decompressor::start_piece(std::string&& data) {
+
+    while (!pending.empty() && (pending.size() >= max_pending || buffered >= max_buffered))
+        write_piece();
+
+    std::shared_ptr<std::string> pdata = std::make_shared<std::string>(std::move(data));
+    pending.push_back({ pdata, pool.push([this, pdata](int) { return decompress_piece(*pdata); }) });
+}
+
+// write the decompression of the oldest piece
+void parallel_decompressor::write_piece() {
+
+    piece front = std::move(pending.front());
+    pending.pop_front();
+
+    auto result = front.result.get();
+
+    // once over the budget, the rest of the pieces are decompressed as a single stream
+    if (overflow) {
+        buffered -= result.output.size();
+        carry += *front.data;
+        return;
+    }
+
+    // a piece after one that did not decompress is decompressed along with it
+    if (!carry.empty()) {
+        buffered -= result.output.size();
+        carry += *front.data;
+        result = decompress_piece(carry);
+    }
+
+    if (result.overflow) {
+        overflow = true;
+        if (carry.empty())
+            carry = std::move(*front.data);
+        return;
+    }
+
+    if (!result.ok) {
+        if (carry.empty())
+            carry = std::move(*front.data);
+        return;
+    }
+    carry.clear();
+
+    if (ok && !write_all(outfd, result.output.data(), result.output.size()))
+        ok = false;
+
+    buffered -= result.output.size();
+}
+
+// write the pieces in progress, then decompress the rest of the input as a single stream
+bool parallel_decompressor::decompress_stream(std::string&& head, int infd) {
+
+    while (!pending.empty())
+        write_piece();
+
+    stream_input input = { carry + head, infd, std::vector<char>() };
+    carry.clear();
+    head.clear();
+    head.shrink_to_fit();
+
+    std::unique_ptr<archive> ar(compressed_reader());
+    if (archive_read_open(ar.get(), &input, nullptr, stream_read_callback, nullptr) != ARCHIVE_OK)
+        return false;
+
+    return decompress_data(ar.get(), [this](const char* data, size_t size) {
+        return write_all(outfd, data, size);
+    }) && ok;
+}
+
+bool parallel_decompressor::decompress(int infd, int outfd) {
+
+    this->outfd = outfd;
+
+    std::string buffer;
+    size_t scan = 0;
+    bool eof = false;
+    bool started = false;
+    bool checked = false;
+    while (!eof && ok) {
+
+        // read ahead
+        size_t size = buffer.size();
+        buffer.resize(size + read_size);
+        auto count = read(infd, &buffer[size], (unsigned int) read_size);
+        buffer.resize(size + (count > 0 ? (size_t) count : 0));
+        eof = count <= 0;
+
+        // split off a piece at each start of a stream past the piece size
+        while (buffer.size() >= lookahead) {
+
+            size_t from = std::max(scan, piece_size);
+            size_t to = buffer.size() - lookahead + 1;
+            size_t pos = from;
+            while (pos < to && !is_stream_start(&buffer[pos]))
+                ++pos;
+
+            if (pos >= to) {
+                scan = std::max(from, to);
+                break;
+            }
+
+            start_piece(buffer.substr(0, pos));
+            buffer.erase(0, pos);
+            scan = 1;
+            started = true;
+        }
+
+        // no second stream within the first piece, so the input is a single stream
+        if (!started && !checked && buffer.size() >= piece_size + lookahead) {
+
+            checked = true;
+
+            size_t pos = 1;
+            while (pos < piece_size && !is_stream_start(&buffer[pos]))
+                ++pos;
+
+            if (pos == piece_size)
+                return decompress_stream(std::move(buffer), infd);
+        }
+
+        // over the budget of output, or no start of a stream in a long stretch
+        if (overflow || (!eof && buffer.size() >= max_piece_factor * piece_size))
+            return decompress_stream(std::move(buffer), infd);
+    }
+
+    // the rest of the input is the last piece
+    if (!buffer.empty() || !started)
+        start_piece(std::move(buffer));
+
+    while (!pending.empty())
+        write_piece();
+
+    // the input is all read, so this is only the carry
+    if (overflow)
+        return decompress_stream(std::string(), infd);
+
+    if (!carry.empty())
+        ok = false;
+
+    return ok;
+}
+
+void decompress_srcml_parallel(const srcml_request_t& srcml_request,
+                               const srcml_input_t& input_sources,
+                               const srcml_output_dest& destination) {
+
+    int infd = contains<int>(input_sources[0]) ? *input_sources[0].fd : open(input_sources[0].resource.c_str(), O_RDONLY);
+    if (infd == -1) {
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to open file " + src_prefix_resource(input_sources[0].filename));
+        exit(1);
+    }
+
+    parallel_decompressor decompressor(input_sources[0].compressions.front(), srcml_request.max_threads);
+    if (!decompressor.decompress(infd, *destination.fd))
+        SRCMLstatus(ERROR_MSG, "srcml: Unable to decompress " + src_prefix_resource(input_sources[0].filename));
+
+    if (!contains<int>(input_sources[0]))
+        close(infd);
+
+    // important to close, since this is how the file descriptor reader get an EOF
+    close(*destination.fd);
+}
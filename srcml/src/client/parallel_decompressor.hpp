@@ -0,0 +1,108 @@
+/**
+ * @file parallel_decompressor.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef PARALLEL_DECOMPRESSOR_HPP
+#define PARALLEL_DECOMPRESSOR_HPP
+
+#include <srcml_cli.hpp>
+#include <srcml_input_src.hpp>
+#include <ctpl_stl.h>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+
+/*
+ * parallel_decompressor
+ *
+ * Decompresses input made of concatenated compressed streams (gzip members,
+ * bzip2 or xz streams, or zstd frames), such as from parallel_compressor, on a
+ * pool of threads. The input is read ahead, and split into pieces at the
+ * start of a stream. Each piece is decompressed independently, and the
+ * results are written in order. A piece that does not decompress, e.g., from
+ * a split at data that only looks like the start of a stream, is joined with
+ * the following pieces and decompressed again.
+ *
+ * Input without a second stream in the first piece is decompressed as a
+ * single stream, as is the rest of the input once the decompressed output
+ * waiting to be written is over its budget.
+ */
+class parallel_decompressor {
+public:
+
+    // whether the input is a file with a single compression that can be decompressed in pieces
+    static bool supports(const srcml_input_src& input);
+
+    parallel_decompressor(const std::string& compression, int threads, size_t piece_size = 4 * 1024 * 1024,
+                          size_t max_buffered = 64 * 1024 * 1024);
+
+    // decompress all of the input file descriptor into the output file descriptor
+    bool decompress(int infd, int outfd);
+
+private:
+
+    /** decompression of a piece */
+    struct piece_result {
+        bool ok = false;
+        bool overflow = false;
+        std::string output;
+    };
+
+    /** a piece of the input and its decompression */
+    struct piece {
+        std::shared_ptr<std::string> data;
+        std::future<piece_result> result;
+    };
+
+    bool is_stream_start(const char* p) const;
+    piece_result decompress_piece(const std::string& data);
+    void start_piece(std::string&& data);
+    void write_piece();
+    bool decompress_stream(std::string&& head, int infd);
+
+    std::string compression;
+    size_t piece_size;
+    size_t max_pending;
+
+    /** decompressed output of the pieces in progress, and its limit */
+    std::atomic<size_t> buffered;
+    size_t max_buffered;
+
+    ctpl::thread_pool pool;
+
+    std::deque<piece> pending;
+
+    /** input that did not decompress on its own, waiting for the pieces that complete it */
+    std::string carry;
+
+    int outfd = -1;
+    bool ok = true;
+    bool overflow = false;
+};
+
+// decompress the input source into the destination, as a step of srcml_pipe()
+void decompress_srcml_parallel(const srcml_request_t& srcml_request,
+                               const srcml_input_t& input_sources,
+                               const srcml_output_dest& destination);
+
+#endif
@@ -27,11 +27,17 @@
 #include <src_input_libarchive.hpp>
 #include <src_input_filesystem.hpp>
 #include <srcml_input_srcml.hpp>
+#include <srcml_options.hpp>
+#include <ctpl_stl.h>
 
 #include <list>
 #include <deque>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
 #include <archive.h>
 #include <archive_entry.h>
 
@@ -42,6 +48,145 @@
     #include <unistd.h>
 #endif
 
+namespace {
+
+    // List the regular files and subdirectories directly in a directory
+    void list_directory(const std::string& directory, bool parser_test,
+                        std::vector<std::string>& files, std::vector<std::string>& subdirectories) {
+
+        auto darchive = archive_read_disk_new();
+#if ARCHIVE_VERSION_NUMBER >= 3002003
+        archive_read_disk_set_behavior(darchive, ARCHIVE_READDISK_NO_ACL | ARCHIVE_READDISK_NO_XATTR | ARCHIVE_READDISK_NO_FFLAGS);
+#elif ARCHIVE_VERSION_NUMBER >= 3002000
+        archive_read_disk_set_behavior(darchive, ARCHIVE_READDISK_NO_XATTR);
+#endif
+        archive_read_disk_open(darchive, directory.c_str());
+
+        /* Null entry with archive_read_next_header() causes a segfault on ARCHIVE_VERSION_NUMBER < 300200
+           Creating an entry and using archive_read_next_header2() works */
+        archive_entry* entry = archive_entry_new();
+        bool first = true;
+        while (archive_read_next_header2(darchive, entry) == ARCHIVE_OK) {
+
+            // only descend from the directory itself, its subdirectories are listed separately
+            if (first) {
+                first = false;
+                archive_read_disk_descend(darchive);
+                continue;
+            }
+
+            std::string filename = archive_entry_pathname(entry);
+
+            // do not descend into . directories
+            if (filename[filename.find_last_of("/") + 1] == '.')
+                continue;
+
+            if (archive_entry_filetype(entry) == AE_IFDIR) {
+                subdirectories.push_back(filename);
+                continue;
+            }
+
+            if (archive_entry_filetype(entry) != AE_IFREG)
+                continue;
+
+            if (parser_test && filename.substr(filename.find_last_of(".") + 1) != "xml")
+                continue;
+
+            files.push_back(filename);
+        }
+        archive_entry_free(entry);
+        archive_read_free(darchive);
+    }
+
+    // List all the regular files in a directory tree, with directories listed concurrently
+    std::vector<std::string> directory_files(const std::string& root, int max_threads, bool parser_test) {
+
+        std::vector<std::string> files;
+        std::deque<std::string> directories(1, root);
+        int listing = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        auto lister = [&]() {
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+
+                // done when no directories are left, and none are being listed that could add more
+                cv.wait(lock, [&]() { return !directories.empty() || listing == 0; });
+                if (directories.empty())
+                    return;
+
+                std::string directory = directories.front();
+                directories.pop_front();
+                ++listing;
+                lock.unlock();
+
+                std::vector<std::string> found_files;
+                std::vector<std::string> found_directories;
+                list_directory(directory, parser_test, found_files, found_directories);
+
+                lock.lock();
+                files.insert(files.end(), found_files.begin(), found_files.end());
+                directories.insert(directories.end(), found_directories.begin(), found_directories.end());
+                --listing;
+                cv.notify_all();
+            }
+        };
+
+        std::vector<std::thread> listers;
+        for (int i = 1; i < max_threads; ++i)
+            listers.emplace_back(lister);
+        lister();
+        for (auto& thread : listers)
+            thread.join();
+
+        // deterministic order regardless of the order of listing
+        std::sort(files.begin(), files.end());
+
+        return files;
+    }
+
+    // ParseRequests read from a file, in order
+    typedef std::vector<std::shared_ptr<ParseRequest>> file_requests;
+
+    // Form the ParseRequest of a plain source file, read by the parser instead of libarchive
+    std::shared_ptr<ParseRequest> plain_file_request(srcml_archive* srcml_arch,
+                                                     const srcml_request_t& srcml_request,
+                                                     const srcml_input_src& input_file) {
+
+        // compressed files and archives need libarchive, and libarchive provides the timestamp
+        if (!input_file.compressions.empty() || !input_file.archives.empty() || option(SRCML_COMMAND_TIMESTAMP))
+            return nullptr;
+
+        // files without a known source extension are left to libarchive for reporting
+        const char* extension_language = srcml_archive_check_extension(srcml_arch, input_file.resource.c_str());
+        if (!extension_language)
+            return nullptr;
+
+        std::string filename = input_file.resource;
+        while (filename.size() > 2 && filename[0] == '.' && filename[1] == '/')
+            filename.erase(0, 2);
+
+        if (srcml_request.att_filename && srcml_archive_is_solitary_unit(srcml_arch))
+            filename = *srcml_request.att_filename;
+
+        std::shared_ptr<ParseRequest> prequest(ParseRequest::create());
+
+        if (option(SRCML_COMMAND_NOARCHIVE))
+            prequest->disk_dir = srcml_request.output_filename;
+
+        prequest->filename = filename;
+        prequest->url = srcml_request.att_url;
+        prequest->version = srcml_request.att_version;
+        prequest->srcml_arch = srcml_arch;
+        prequest->language = srcml_request.att_language ? *srcml_request.att_language : extension_language;
+        prequest->disk_filename = input_file.resource;
+
+        return prequest;
+    }
+}
+
 int src_input_filesystem(ParseQueue& queue,
                           srcml_archive* srcml_arch,
                           const srcml_request_t& srcml_request,
@@ -55,69 +200,72 @@ int src_input_filesystem(ParseQueue& queue,
         free(cwd);
     }
 
-    // get a list of files (including directories) from the current directory
-    std::vector<std::string> files;
+    bool parser_test = (srcml_request.command & SRCML_COMMAND_PARSER_TEST) != 0;
 
-    // start at the root of the tree
-    auto darchive = archive_read_disk_new();
-#if ARCHIVE_VERSION_NUMBER >= 3002003
-    archive_read_disk_set_behavior(darchive, ARCHIVE_READDISK_NO_ACL | ARCHIVE_READDISK_NO_XATTR | ARCHIVE_READDISK_NO_FFLAGS);
-#elif ARCHIVE_VERSION_NUMBER >= 3002000
-    archive_read_disk_set_behavior(darchive, ARCHIVE_READDISK_NO_XATTR);
-#endif
-    archive_read_disk_open(darchive, input.c_str());
+    int max_threads = srcml_request.max_threads > 1 ? srcml_request.max_threads : 1;
 
-    /* Null entry with archive_read_next_header() causes a segfault on ARCHIVE_VERSION_NUMBER < 300200
-       Creating an entry and using archive_read_next_header2() works */
-    archive_entry* entry = archive_entry_new();
-    bool first = true;
-    int status = ARCHIVE_OK;
-    while ((status = archive_read_next_header2(darchive, entry)) == ARCHIVE_OK) {
+    // get a list of files from the directory tree
+    std::vector<std::string> files = directory_files(input, max_threads, parser_test);
 
-        std::string filename = archive_entry_pathname(entry);
+    if (parser_test) {
+        for (auto& filename : files) {
 
-        // do not descend into . directories
-        if (filename[filename.find_last_of("/") + 1] == '.') {
-            continue;
+            srcml_input_src input_file(filename);
+            srcml_input_srcml(queue, srcml_arch, srcml_request, input_file, srcml_request.revision);
         }
 
-        archive_read_disk_descend(darchive);
-        if (first) {
-            first = false;
-            continue;
-        }
+        return 1;
+    }
 
-        if (archive_entry_filetype(entry) != AE_IFREG)
-            continue;
+    // files are read ahead concurrently, and their requests scheduled in order
+    ctpl::thread_pool pool(max_threads);
+    std::deque<std::future<file_requests>> reads;
+    const size_t max_reads = 4 * max_threads;
 
-        if (srcml_request.command & SRCML_COMMAND_PARSER_TEST) {
-            if (filename.substr(filename.find_last_of(".") + 1) != "xml")
-                continue;
-        }
+    auto schedule_next = [&]() {
 
-        files.push_back(archive_entry_pathname(entry));
-    }
-    archive_entry_free(entry);
-    archive_read_free(darchive);
+        for (auto& prequest : reads.front().get())
+            queue.schedule(prequest);
 
-    std::sort(files.begin(), files.end());
+        reads.pop_front();
+    };
 
     for (auto& filename : files) {
 
-        srcml_input_src input_file(filename);
+        reads.push_back(pool.push([&srcml_arch, &srcml_request](int, const std::string& filename) {
 
-        // If a directory contains archives skip them
-        if (!(srcml_request.command & SRCML_COMMAND_PARSER_TEST) && !(input_file.archives.empty())) {
-            input_file.skip = true;
-        }
+            srcml_input_src input_file(filename);
+
+            // If a directory contains archives skip them
+            if (!(input_file.archives.empty()))
+                input_file.skip = true;
 
-        if (srcml_request.command & SRCML_COMMAND_PARSER_TEST) {
-            srcml_input_srcml(queue, srcml_arch, srcml_request, input_file, srcml_request.revision);
-        } else {
             input_file.prefix = filename.substr(0, filename.find_last_of('/'));
-            src_input_libarchive(queue, srcml_arch, srcml_request, input_file);
-        }
+
+            file_requests requests;
+
+            // plain source files are read directly by the parsing thread
+            if (!input_file.skip) {
+                if (auto prequest = plain_file_request(srcml_arch, srcml_request, input_file)) {
+                    requests.push_back(prequest);
+                    return requests;
+                }
+            }
+
+            src_input_libarchive([&requests](std::shared_ptr<ParseRequest> prequest) { requests.push_back(prequest); },
+                                 srcml_arch, srcml_request, input_file);
+
+            return requests;
+        }, filename));
+
+        if (reads.size() >= max_reads)
+            schedule_next();
     }
 
+    while (!reads.empty())
+        schedule_next();
+
+    pool.stop(true);
+
     return 1;
 }
@@ -37,28 +37,76 @@ typedef SSIZE_T ssize_t;
 #include <cstring>
 #include <libarchive_utilities.hpp>
 
-archive* libarchive_input_file(const srcml_input_src& input_file) {
+#ifndef _MSC_BUILD
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    // new libarchive reader for all supported formats and compressions
+    archive* libarchive_input_new() {
 
-    std::unique_ptr<archive> arch(archive_read_new());
+        archive* arch = archive_read_new();
 
-    archive_read_support_format_ar(arch.get());
-    archive_read_support_format_cpio(arch.get());
-    archive_read_support_format_gnutar(arch.get());
-    archive_read_support_format_iso9660(arch.get());
-    archive_read_support_format_tar(arch.get());
-    archive_read_support_format_xar(arch.get());
-    archive_read_support_format_zip(arch.get());
-    archive_read_support_format_raw(arch.get());
-    archive_read_support_format_empty(arch.get());
+        archive_read_support_format_ar(arch);
+        archive_read_support_format_cpio(arch);
+        archive_read_support_format_gnutar(arch);
+        archive_read_support_format_iso9660(arch);
+        archive_read_support_format_tar(arch);
+        archive_read_support_format_xar(arch);
+        archive_read_support_format_zip(arch);
+        archive_read_support_format_raw(arch);
+        archive_read_support_format_empty(arch);
+
+        // File Formats
+        archive_read_support_format_7zip(arch);
+        archive_read_support_format_cab(arch);
+        archive_read_support_format_lha(arch);
+        archive_read_support_format_rar(arch);
+
+        // Compressions
+        archive_read_support_filter_all(arch);
+
+        return arch;
+    }
 
-    // File Formats
-    archive_read_support_format_7zip(arch.get());
-    archive_read_support_format_cab(arch.get());
-    archive_read_support_format_lha(arch.get());
-    archive_read_support_format_rar(arch.get());
+    // map an uncompressed archive file into memory, so the data of its entries can be used in place
+    // the mapping is shared by the parse requests that use it
+    std::shared_ptr<const char> map_archive_file(const srcml_input_src& input_file, size_t& size) {
 
-    // Compressions
-    archive_read_support_filter_all(arch.get());
+#ifndef _MSC_BUILD
+        if (input_file.protocol != "file" || contains<int>(input_file) || contains<FILE*>(input_file) ||
+            input_file.archives.empty() || !input_file.compressions.empty())
+            return nullptr;
+
+        int fd = open(input_file.c_str(), O_RDONLY);
+        if (fd == -1)
+            return nullptr;
+
+        struct stat s;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &s) == 0 && s.st_size > 0)
+            p = mmap(nullptr, (size_t) s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED)
+            return nullptr;
+
+        size = (size_t) s.st_size;
+        madvise(p, size, MADV_SEQUENTIAL);
+
+        return std::shared_ptr<const char>((const char*) p, [size](const char* p) { munmap((void*) p, size); });
+#else
+        return nullptr;
+#endif
+    }
+}
+
+archive* libarchive_input_file(const srcml_input_src& input_file) {
+
+    std::unique_ptr<archive> arch(libarchive_input_new());
 
     int status;
     const int buffer_size = 16384;
@@ -99,6 +147,16 @@ int src_input_libarchive(ParseQueue& queue,
                           const srcml_request_t& srcml_request,
                           const srcml_input_src& input_file) {
 
+    return src_input_libarchive([&queue](std::shared_ptr<ParseRequest> prequest) { queue.schedule(prequest); },
+                                srcml_arch, srcml_request, input_file);
+}
+
+// Convert input to a ParseRequest and pass the request to schedule
+int src_input_libarchive(std::function<void(std::shared_ptr<ParseRequest>)> schedule,
+                          srcml_archive* srcml_arch,
+                          const srcml_request_t& srcml_request,
+                          const srcml_input_src& input_file) {
+
     // don't process if non-archive, non-compressed, and we don't handle the extension
     // this is to prevent trying to open, with srcml_archive_open_filename(), a non-srcml file,
     // which then hangs
@@ -117,7 +175,7 @@ int src_input_libarchive(ParseQueue& queue,
         }
 
         // form the parsing request
-        std::shared_ptr<ParseRequest> prequest(new ParseRequest);
+        std::shared_ptr<ParseRequest> prequest(ParseRequest::create());
         prequest->filename = filename;
         prequest->url = srcml_request.att_url;
         prequest->version = srcml_request.att_version;
@@ -126,12 +184,23 @@ int src_input_libarchive(ParseQueue& queue,
         prequest->status = SRCML_STATUS_UNSET_LANGUAGE;
 
         // schedule for parsing
-        queue.schedule(prequest);
+        schedule(prequest);
 
         return 1;
     }
 
-    std::unique_ptr<archive> arch(libarchive_input_file(input_file));
+    // an uncompressed archive file is read from memory, so entries in a single block are used in place
+    size_t mapped_size = 0;
+    std::shared_ptr<const char> mapping = map_archive_file(input_file, mapped_size);
+
+    std::unique_ptr<archive> arch;
+    if (mapping) {
+        arch.reset(libarchive_input_new());
+        if (archive_read_open_memory(arch.get(), mapping.get(), mapped_size) != ARCHIVE_OK)
+            arch.reset();
+    } else {
+        arch.reset(libarchive_input_file(input_file));
+    }
     if (!arch) {
         return 0;
     }
@@ -225,7 +294,7 @@ int src_input_libarchive(ParseQueue& queue,
         }
 
         // form the parsing request
-        std::shared_ptr<ParseRequest> prequest(new ParseRequest);
+        std::shared_ptr<ParseRequest> prequest(ParseRequest::create());
 
         if (option(SRCML_COMMAND_NOARCHIVE))
             prequest->disk_dir = srcml_request.output_filename;
@@ -254,7 +323,7 @@ int src_input_libarchive(ParseQueue& queue,
         // fill up the parse request buffer
         if (!status && !prequest->status) {
             // if we know the size, create the right sized data_buffer
-            if (archive_entry_size_is_set(entry))
+            if (archive_entry_size_is_set(entry) && !mapping)
                 prequest->buffer.reserve(archive_entry_size(entry));
 
             const char* buffer;
@@ -264,13 +333,32 @@ int src_input_libarchive(ParseQueue& queue,
 #else
             int64_t offset;
 #endif
+            bool inplace = false;
             while (status == ARCHIVE_OK && archive_read_data_block(arch.get(), (const void**) &buffer, &size, &offset) == ARCHIVE_OK) {
+
+                if (size == 0)
+                    continue;
+
+                // the first block, if in the mapped archive, is used in place
+                if (mapping && !inplace && prequest->buffer.empty() &&
+                    buffer >= mapping.get() && buffer + size <= mapping.get() + mapped_size) {
+                    prequest->view = std::shared_ptr<const char>(mapping, buffer);
+                    prequest->view_size = size;
+                    inplace = true;
+                    continue;
+                }
+
+                // data in more than one block, or not in the mapped archive, is copied
+                if (prequest->view) {
+                    prequest->buffer.insert(prequest->buffer.end(), prequest->view.get(), prequest->view.get() + prequest->view_size);
+                    prequest->view.reset();
+                }
                 prequest->buffer.insert(prequest->buffer.end(), buffer, buffer + size);
             }
         }
 
         // schedule for parsing
-        queue.schedule(prequest);
+        schedule(prequest);
 
         ++count;
     }
@@ -28,6 +28,7 @@
 #include <srcml.h>
 #include <srcml_cli.hpp>
 #include <string>
+#include <functional>
 #include <ParseQueue.hpp>
 #include <srcml_input_src.hpp>
 #include <src_archive.hpp>
@@ -39,4 +40,10 @@ int src_input_libarchive(ParseQueue& queue,
                           const srcml_request_t& srcml_request,
                           const srcml_input_src& input);
 
+// Form the ParseRequests of the input, passing each to schedule instead of a queue
+int src_input_libarchive(std::function<void(std::shared_ptr<ParseRequest>)> schedule,
+                          srcml_archive* srcml_arch,
+                          const srcml_request_t& srcml_request,
+                          const srcml_input_src& input);
+
 #endif
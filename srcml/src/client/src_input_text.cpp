@@ -64,7 +64,7 @@ int src_input_text(ParseQueue& queue,
     while (ptext) {
 
         // form the parsing request
-        std::shared_ptr<ParseRequest> prequest(new ParseRequest);
+        std::shared_ptr<ParseRequest> prequest(ParseRequest::create());
 
         if (option(SRCML_COMMAND_NOARCHIVE))
             prequest->disk_dir = srcml_request.output_filename;
@@ -25,8 +25,22 @@
 #include <iostream>
 #include <srcml_utilities.hpp>
 #include <mkDir.hpp>
+#include <ctpl_stl.h>
+#include <deque>
+#include <future>
+#include <memory>
+#include <algorithm>
 
-void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_dir, TraceLog& log) {
+namespace {
+
+    // unit extraction in progress
+    struct pending_unparse {
+        std::string filename;
+        std::future<int> status;
+    };
+}
+
+void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_dir, TraceLog& log, int max_threads) {
 
     // construct the relative directory
     std::string prefix;
@@ -36,8 +50,14 @@ void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_
     // create output directory structure as needed
     mkDir dir;
 
+    // unparse and write the files concurrently while reading the next units.
+    // The number of units in flight is bounded so that the whole archive is not in memory
+    max_threads = std::max(max_threads, 1);
+    ctpl::thread_pool pool(max_threads);
+    std::deque<pending_unparse> pending;
+    const size_t max_pending = 4 * (size_t) max_threads;
+
     int count = 0;
-    std::string last;
     while (std::unique_ptr<srcml_unit> unit{srcml_archive_read_unit(srcml_arch)}) {
 
         const char* cfilename = srcml_unit_get_filename(unit.get());
@@ -62,6 +82,23 @@ void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_
         // unparse directory to filename
         log << ++count << fullfilename;
 
-        srcml_unit_unparse_filename(unit.get(), fullfilename.c_str());
+        // a repeated filename has to wait for the earlier unit, so that the last unit wins
+        auto same = std::find_if(pending.rbegin(), pending.rend(), [&fullfilename](const pending_unparse& p) {
+            return p.filename == fullfilename;
+        });
+        if (same != pending.rend())
+            same->status.wait();
+
+        std::shared_ptr<srcml_unit> punit(unit.release(), srcml_unit_free);
+        pending.push_back({ fullfilename, pool.push([punit, fullfilename](int) {
+            return srcml_unit_unparse_filename(punit.get(), fullfilename.c_str());
+        }) });
+
+        if (pending.size() >= max_pending) {
+            pending.front().status.wait();
+            pending.pop_front();
+        }
     }
+
+    pool.stop(true);
 }
@@ -27,6 +27,6 @@
 #include <string>
 #include <TraceLog.hpp>
 
-void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_dir, TraceLog& log);
+void src_output_filesystem(srcml_archive* srcml_arch, const std::string& output_dir, TraceLog& log, int max_threads = 1);
 
 #endif
@@ -31,38 +31,34 @@
 #include <memory>
 #include <libarchive_utilities.hpp>
 #include <srcml_utilities.hpp>
+#include <ctpl_stl.h>
+#include <deque>
+#include <future>
+#include <utility>
+#include <algorithm>
 
-void src_output_libarchive(srcml_archive* srcml_arch, archive* src_archive) {
+namespace {
 
-    ssize_t arch_status = ARCHIVE_OK;
-    int unitcounter = 0;
-    while (std::unique_ptr<srcml_unit> unit{srcml_archive_read_unit(srcml_arch)}) {
+    // source of a unit, unparsed into a buffer
+    struct unparsed_unit {
+        std::string filename;
+        std::future<std::pair<char*, size_t>> buffer;
+    };
 
-        ++unitcounter;
+    // write a unit source buffer as an entry in the source archive
+    bool write_entry(archive* src_archive, unparsed_unit& unparsed) {
 
-        // have to make sure we have a valid filename
-        std::string newfilename = srcml_unit_get_filename(unit.get()) ? srcml_unit_get_filename(unit.get()) : "";
-        if (newfilename.empty()) {
-            newfilename = "srcml_unit_";
-            newfilename += std::to_string(unitcounter);
-            if (language_to_std_extension(srcml_unit_get_language(unit.get())) != "")
-                newfilename += language_to_std_extension(srcml_unit_get_language(unit.get()));
-            SRCMLstatus(WARNING_MSG, "A srcML unit without a filename saved as " + newfilename);
-        }
+        auto result = unparsed.buffer.get();
+        std::unique_ptr<char, void (*)(char*)> pbuffer(result.first, srcml_memory_free);
+        size_t buffer_size = result.second;
 
         // setup the entry header
         std::unique_ptr<archive_entry> entry(archive_entry_new());
         if (!entry)
-            break;
-
-        // Convert from srcML back to source in a buffer
-        char* buffer;
-        size_t buffer_size;
-        srcml_unit_unparse_memory(unit.get(), &buffer, &buffer_size);
-        std::unique_ptr<char> pbuffer(buffer);
+            return false;
 
         // setup the entry
-        archive_entry_set_pathname(entry.get(), newfilename.c_str());
+        archive_entry_set_pathname(entry.get(), unparsed.filename.c_str());
         archive_entry_set_size(entry.get(), buffer_size);
         archive_entry_set_filetype(entry.get(), AE_IFREG);
         archive_entry_set_perm(entry.get(), 0644);
@@ -72,14 +68,71 @@ void src_output_libarchive(srcml_archive* srcml_arch, archive* src_archive) {
         archive_entry_set_ctime(entry.get(), now, 0);
         archive_entry_set_mtime(entry.get(), now, 0);
 
-        if ((arch_status = archive_write_header(src_archive, entry.get())) != ARCHIVE_OK)
-            break;
+        if (archive_write_header(src_archive, entry.get()) != ARCHIVE_OK)
+            return false;
 
         // write the data into the archive
-        arch_status = archive_write_data(src_archive, pbuffer.get(), (size_t) buffer_size);
-        if (arch_status == -1) {
-            SRCMLstatus(WARNING_MSG, "Unable to save " + newfilename + " to source archive");
+        if (archive_write_data(src_archive, pbuffer.get(), buffer_size) == -1) {
+            SRCMLstatus(WARNING_MSG, "Unable to save " + unparsed.filename + " to source archive");
+            return false;
+        }
+
+        return true;
+    }
+}
+
+void src_output_libarchive(srcml_archive* srcml_arch, archive* src_archive, int max_threads) {
+
+    // units are converted from srcML back to source concurrently, and written
+    // to the source archive in their original order by this thread
+    max_threads = std::max(max_threads, 1);
+    ctpl::thread_pool pool(max_threads);
+    std::deque<unparsed_unit> pending;
+    const size_t max_pending = 4 * (size_t) max_threads;
+
+    bool ok = true;
+    int unitcounter = 0;
+    while (ok) {
+
+        std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(srcml_arch));
+        if (!unit)
             break;
+
+        ++unitcounter;
+
+        // have to make sure we have a valid filename
+        std::string newfilename = srcml_unit_get_filename(unit.get()) ? srcml_unit_get_filename(unit.get()) : "";
+        if (newfilename.empty()) {
+            newfilename = "srcml_unit_";
+            newfilename += std::to_string(unitcounter);
+            if (language_to_std_extension(srcml_unit_get_language(unit.get())) != "")
+                newfilename += language_to_std_extension(srcml_unit_get_language(unit.get()));
+            SRCMLstatus(WARNING_MSG, "A srcML unit without a filename saved as " + newfilename);
+        }
+
+        // convert from srcML back to source in a buffer
+        std::shared_ptr<srcml_unit> punit(unit.release(), srcml_unit_free);
+        pending.push_back({ newfilename, pool.push([punit](int) {
+            char* buffer = nullptr;
+            size_t buffer_size = 0;
+            srcml_unit_unparse_memory(punit.get(), &buffer, &buffer_size);
+            return std::make_pair(buffer, buffer_size);
+        }) });
+
+        // write out the oldest unit once enough are in progress
+        if (pending.size() >= max_pending) {
+            ok = write_entry(src_archive, pending.front());
+            pending.pop_front();
         }
     }
+
+    // write out the remaining units in order
+    for (auto& unparsed : pending) {
+        if (ok)
+            ok = write_entry(src_archive, unparsed);
+        else
+            srcml_memory_free(unparsed.buffer.get().first);
+    }
+
+    pool.stop(true);
 }
@@ -0,0 +1,168 @@
+/**
+ * @file srcml_channel.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <srcml_channel.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+bool srcml_channel::write(const char* data, size_t size) {
+
+    while (size) {
+
+        // start a new buffer, reusing one from the reader if possible
+        if (writing.capacity() == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (read_closed)
+                return false;
+
+            if (!empty.empty()) {
+                writing.swap(empty.back());
+                empty.pop_back();
+            }
+            writing.clear();
+            writing.reserve(buffer_size);
+        }
+
+        size_t count = std::min(size, buffer_size - writing.size());
+        writing.insert(writing.end(), data, data + count);
+        data += count;
+        size -= count;
+
+        if (writing.size() == buffer_size)
+            hand_over();
+    }
+
+    return true;
+}
+
+void srcml_channel::close_write() {
+
+    if (!writing.empty())
+        hand_over();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    write_closed = true;
+    changed.notify_all();
+}
+
+// hand the current buffer over to the reader, waiting while the queue is full
+void srcml_channel::hand_over() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return full.size() < capacity || read_closed; });
+
+    if (!read_closed)
+        full.push_back(std::move(writing));
+    writing = std::vector<char>();
+
+    changed.notify_all();
+}
+
+// move to the next full buffer, returning the current one for reuse
+bool srcml_channel::next_buffer() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (reading.capacity() && empty.size() < capacity)
+        empty.push_back(std::move(reading));
+    reading = std::vector<char>();
+    read_pos = 0;
+
+    changed.wait(lock, [this]() { return !full.empty() || write_closed; });
+    if (full.empty())
+        return false;
+
+    reading.swap(full.front());
+    full.pop_front();
+    changed.notify_all();
+
+    return true;
+}
+
+size_t srcml_channel::read(char* data, size_t size) {
+
+    while (read_pos == reading.size()) {
+        if (!next_buffer())
+            return 0;
+    }
+
+    size_t count = std::min(size, reading.size() - read_pos);
+    memcpy(data, reading.data() + read_pos, count);
+    read_pos += count;
+
+    return count;
+}
+
+bool srcml_channel::read_buffer(std::vector<char>& buffer) {
+
+    // any partially read buffer is handed out first
+    if (read_pos < reading.size()) {
+        reading.erase(reading.begin(), reading.begin() + read_pos);
+        buffer.swap(reading);
+        reading.clear();
+        read_pos = 0;
+        return true;
+    }
+
+    reading.swap(buffer);
+    if (!next_buffer())
+        return false;
+
+    buffer.swap(reading);
+    read_pos = 0;
+    reading.clear();
+
+    return true;
+}
+
+void srcml_channel::close_read() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    read_closed = true;
+    full.clear();
+    changed.notify_all();
+}
+
+int srcml_channel::write_callback(void* context, const char* buffer, int len) {
+
+    return ((srcml_channel*) context)->write(buffer, (size_t) len) ? len : -1;
+}
+
+int srcml_channel::close_write_callback(void* context) {
+
+    ((srcml_channel*) context)->close_write();
+
+    return 0;
+}
+
+int srcml_channel::read_callback(void* context, char* buffer, int len) {
+
+    return (int) ((srcml_channel*) context)->read(buffer, (size_t) len);
+}
+
+int srcml_channel::close_read_callback(void* context) {
+
+    ((srcml_channel*) context)->close_read();
+
+    return 0;
+}
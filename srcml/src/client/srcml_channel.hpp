@@ -0,0 +1,93 @@
+/**
+ * @file srcml_channel.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcml command-line client.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcml command-line client; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef SRCML_CHANNEL_HPP
+#define SRCML_CHANNEL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/*
+ * srcml_channel
+ *
+ * In-memory connection between two steps of the internal pipeline, in place
+ * of a pipe. The writer fills large buffers, and hands each full buffer over
+ * to the reader through a bounded queue. Buffers the reader is done with
+ * are reused by the writer.
+ */
+class srcml_channel {
+public:
+
+    srcml_channel(size_t buffer_size = 1024 * 1024, size_t capacity = 4)
+        : buffer_size(buffer_size), capacity(capacity ? capacity : 1) {}
+
+    // append data, handing over each buffer as it fills
+    bool write(const char* data, size_t size);
+
+    // hand over the last buffer, and end the data
+    void close_write();
+
+    // copy up to size bytes of data, 0 at the end
+    size_t read(char* data, size_t size);
+
+    // exchange the buffer for the next full buffer of data, false at the end
+    bool read_buffer(std::vector<char>& buffer);
+
+    // the reader is done, so any further writes are dropped
+    void close_read();
+
+    // callbacks for srcml_archive_write_open_io() and srcml_archive_read_open_io()
+    static int write_callback(void* context, const char* buffer, int len);
+    static int close_write_callback(void* context);
+    static int read_callback(void* context, char* buffer, int len);
+    static int close_read_callback(void* context);
+
+private:
+    void hand_over();
+    bool next_buffer();
+
+    size_t buffer_size;
+    size_t capacity;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    /** full buffers, in order, waiting for the reader */
+    std::deque<std::vector<char>> full;
+
+    /** buffers done with by the reader, for reuse by the writer */
+    std::vector<std::vector<char>> empty;
+
+    bool write_closed = false;
+    bool read_closed = false;
+
+    /** only used by the writer */
+    std::vector<char> writing;
+
+    /** only used by the reader */
+    std::vector<char> reading;
+    size_t read_pos = 0;
+};
+
+#endif
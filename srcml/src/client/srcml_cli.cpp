@@ -195,6 +195,11 @@ srcml_request_t parseCLI11(int argc, char* argv[]) {
         ->type_name("NUM")
         ->group("GENERAL OPTIONS");
 
+    app.add_option("--compression-threads", srcml_request.compression_threads,
+        "Compress .gz, .bz2, .xz, and .zst output in blocks on NUM threads, default a single stream")
+        ->type_name("NUM")
+        ->group("GENERAL OPTIONS");
+
     // src2srcml_options "CREATING SRCML"
     auto text =
     app.add_option("--text,-t",
@@ -246,10 +251,28 @@ srcml_request_t parseCLI11(int argc, char* argv[]) {
         "Set the input source-code encoding")->type_name("ENCODING")
         ->group("CREATING SRCML");
 
+    app.add_option("--parse-timeout", srcml_request.parse_timeout,
+        "Stop parsing a file after MSEC milliseconds, and store it as text with an error attribute")
+        ->type_name("MSEC")
+        ->group("CREATING SRCML");
+
+    app.add_option("--parse-max-size", srcml_request.parse_max_size,
+        "Do not parse a file larger than SIZE bytes, and store it as text with an error attribute")
+        ->type_name("SIZE")
+        ->group("CREATING SRCML");
+
     app.add_flag_callback("--archive,-r",      [&]() { *srcml_request.markup_options |= SRCML_ARCHIVE; },
         "Create a srcML archive, default for multiple input files")
         ->group("CREATING SRCML");
 
+    app.add_flag_callback("--index",      [&]() { *srcml_request.markup_options |= SRCML_INDEX; },
+        "Append a unit index to a srcML archive, for direct access to units")
+        ->group("CREATING SRCML");
+
+    app.add_flag_callback("--binary",     [&]() { *srcml_request.markup_options |= SRCML_BINARY; },
+        "Output binary srcML, a compact encoding for input to another srcml")
+        ->group("CREATING SRCML");
+
     auto output_xml =
     app.add_flag_callback("--output-srcml,-X",   [&]() { srcml_request.command |= SRCML_COMMAND_XML; },
         "Output in XML instead of text")
@@ -72,6 +72,11 @@ const int SRCML_ARCHIVE                           = 1<<25;
 
 const int SRCML_HASH                              = 1<<26;
 
+// markup options past the bits of the commands
+const long long SRCML_BINARY                      = 1LL<<31;
+
+const long long SRCML_INDEX                       = 1LL<<32;
+
 const int SRCML_COMMAND_XML_RAW                   = 1<<27;
 const int SRCML_COMMAND_XML_FRAGMENT              = 1<<28;
 
@@ -118,7 +123,7 @@ struct srcml_request_t {
     boost::optional<int> stdindex;
 
     int command = 0;
-    boost::optional<int> markup_options;
+    boost::optional<long long> markup_options;
 
     // unit attributes
     boost::optional<std::string> att_language;
@@ -158,6 +163,13 @@ struct srcml_request_t {
     int unit = 0;
     int max_threads;
 
+    // threads for compressing output in blocks, 0 for a single compressed stream
+    int compression_threads = 0;
+
+    // limits on parsing each unit, 0 for none
+    unsigned int parse_timeout = 0;
+    size_t parse_max_size = 0;
+
     boost::optional<std::string> pretty_format;
 
     boost::optional<size_t> revision;
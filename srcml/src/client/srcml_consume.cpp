@@ -32,6 +32,7 @@
 #include <string>
 #include <SRCMLStatus.hpp>
 #include <Timer.hpp>
+#include <ParserTest.hpp>
 
 // creates initial unit, parses, and then sends unit to write queue
 void srcml_consume(int /* thread_pool_id */, std::shared_ptr<ParseRequest> request, WriteQueue* write_queue) {
@@ -104,7 +105,10 @@ void srcml_consume(int /* thread_pool_id */, std::shared_ptr<ParseRequest> reque
     }
     else if (request->needsparsing) {
 
-        request->status = srcml_unit_parse_memory(request->unit.get(), request->buffer.data(), request->buffer.size());
+        request->status = srcml_unit_parse_memory(request->unit.get(), request->data(), request->size());
+
+        // the unit has its own copy of the source, so any view is released
+        request->view.reset();
 
     }
     if (request->status == SRCML_STATUS_INVALID_ARGUMENT) {
@@ -123,6 +127,13 @@ void srcml_consume(int /* thread_pool_id */, std::shared_ptr<ParseRequest> reque
 
     request->runtime = parsetime.cpu_time_elapsed();
 
+    // parser test round trip, so that only the reporting is done by the writer
+    if (option(SRCML_COMMAND_PARSER_TEST)) {
+        ParserTest::reparse(request.get());
+        write_queue->schedule(request);
+        return;
+    }
+
     // perform any transformations and add them to the request
     srcml_unit_apply_transforms(request->srcml_arch, request->unit.get(), &(request->results));
     if (request->results && srcml_transform_get_type(request->results) == SRCML_RESULT_NONE) {
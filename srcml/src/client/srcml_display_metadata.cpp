@@ -47,7 +47,7 @@ namespace {
         int numUnits = 0;
         long LOC = 0;
         while (true) {
-            std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(srcml_arch));
+            std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit_header(srcml_arch));
             if (!unit)
                 break;
 
@@ -87,7 +87,7 @@ namespace {
         if (xml_encoding)
             std::cout << "encoding=" << "\"" << xml_encoding << "\"\n";
 
-        std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(srcml_arch));
+        std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit_header(srcml_arch));
         int unit_count = 0;
 
         if (!isarchive && unit) {
@@ -111,9 +111,14 @@ namespace {
 
             ++unit_count;
 
-            while (srcml_archive_skip_unit(srcml_arch)) {
+            // unit index has the count without reading the units
+            if (srcml_archive_has_index(srcml_arch)) {
+                unit_count = srcml_archive_get_unit_count(srcml_arch);
+            } else {
+                while (std::unique_ptr<srcml_unit>(srcml_archive_read_unit_header(srcml_arch))) {
 
-                ++unit_count;
+                    ++unit_count;
+                }
             }
 
             std::cout << "units=\"" << unit_count << "\"\n";
@@ -122,10 +127,14 @@ namespace {
 
     int srcml_unit_count(srcml_archive* srcml_arch) {
 
+        // unit index has the count without reading the units
+        if (srcml_archive_has_index(srcml_arch))
+            return srcml_archive_get_unit_count(srcml_arch);
+
         int numUnits = 0;
         while (true) {
 
-            std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit(srcml_arch));
+            std::unique_ptr<srcml_unit> unit(srcml_archive_read_unit_header(srcml_arch));
             if (!unit)
                 break;
 
@@ -154,7 +163,10 @@ void srcml_display_metadata(const srcml_request_t& srcml_request, const srcml_in
         std::unique_ptr<srcml_archive> srcml_arch(srcml_archive_create());
 
         int status = SRCML_STATUS_OK;
-        if (contains<int>(input)) {
+        if (input.channel) {
+            status = srcml_archive_read_open(srcml_arch.get(), input);
+        }
+        else if (contains<int>(input)) {
             status = srcml_archive_read_open_fd(srcml_arch.get(), input);
         }
         else if (contains<FILE*>(input)){
@@ -31,6 +31,8 @@
 #include <thread>
 #include <list>
 #include <srcml_pipe.hpp>
+#include <srcml_channel.hpp>
+#include <create_srcml.hpp>
 
 void srcml_execute(const srcml_request_t& srcml_request,
                    processing_steps_t& pipeline,
@@ -40,6 +42,7 @@ void srcml_execute(const srcml_request_t& srcml_request,
     // create a thread for each step, creating pipes between adjoining steps
     std::list<std::thread> pipethreads;
     int fds[2] = { -1, -1 };
+    std::shared_ptr<srcml_channel> channel;
     for (const auto& command : pipeline) {
 
         // special handling for first and last steps
@@ -49,7 +52,15 @@ void srcml_execute(const srcml_request_t& srcml_request,
         // pipe between each step
         int prevoutfd = fds[0];
         fds[0] = fds[1] = -1;
-        if (pipeline.size() > 1 && !last) {
+        auto prevchannel = channel;
+        channel.reset();
+
+        // srcml from create_srcml is handed to the next step in memory
+        if (pipeline.size() > 1 && !last && command == create_srcml) {
+
+            channel = std::make_shared<srcml_channel>();
+
+        } else if (pipeline.size() > 1 && !last) {
 #if !defined(_MSC_BUILD) && !defined(__MINGW32__)
             if (pipe(fds) == -1) {
                 perror("srcml");
@@ -65,15 +76,22 @@ void srcml_execute(const srcml_request_t& srcml_request,
 #endif
         }
 
+        /* first process_srcml uses input_source, rest input from previous output pipe or channel */
+        srcml_input_t step_input = input_sources;
+        if (!first) {
+            step_input = srcml_input_t(1, prevchannel ? srcml_input_src("stdin://-") : srcml_input_src("stdin://-", prevoutfd));
+            step_input[0].channel = prevchannel;
+        }
+
+        /* last process_srcml uses destination, rest output to pipe or channel */
+        srcml_output_dest step_output = destination;
+        if (!last) {
+            step_output = channel ? srcml_output_dest("-") : srcml_output_dest("-", fds[1]);
+            step_output.channel = channel;
+        }
+
         /* run this step in the sequence */
-        pipethreads.push_back(std::thread(
-            command,
-            srcml_request,
-            /* first process_srcml uses input_source, rest input from previous output pipe */
-            first ? input_sources : srcml_input_t(1, srcml_input_src("stdin://-", prevoutfd)),
-            /* last process_srcml uses destination, rest output to pipe */
-            last  ? destination   : srcml_output_dest("-", fds[1])
-        ));
+        pipethreads.push_back(std::thread(command, srcml_request, step_input, step_output));
     }
 
     // wait on all threads
@@ -21,6 +21,7 @@
  */
 
 #include <srcml_input_src.hpp>
+#include <srcml_channel.hpp>
 
 #if defined(WIN32) || defined(WIN64)
 #include <sys/stat.h>
@@ -95,7 +96,7 @@ srcml_input_src::srcml_input_src(const std::string& other) : arch(0), state(INDE
     }
 
     if (resource != "-" && protocol != "text")
-        state = (extension == ".xml" || extension == ".srcml") ? SRCML : SRC;
+        state = (extension == ".xml" || extension == ".srcml" || extension == ".srcmlb") ? SRCML : SRC;
 
     if (protocol == "text")
         state = SRC;
@@ -146,7 +147,9 @@ int srcml_close_callback(void* context) {
 int srcml_archive_read_open(srcml_archive* arch, const srcml_input_src& input_source) {
 
     int status;
-    if (input_source.arch)
+    if (input_source.channel)
+        status = srcml_archive_read_open_io(arch, input_source.channel.get(), srcml_channel::read_callback, srcml_channel::close_read_callback);
+    else if (input_source.arch)
         status = srcml_archive_read_open_io(arch, input_source.arch, srcml_read_callback, srcml_close_callback);
     else if (contains<int>(input_source))
         status = srcml_archive_read_open_fd(arch, input_source);
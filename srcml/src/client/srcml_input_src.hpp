@@ -35,6 +35,7 @@
 #include <archive.h>
 #include <sys/stat.h>
 #include <numeric>
+#include <memory>
 
 #ifdef WIN32
 #include <io.h>
@@ -44,6 +45,7 @@
 #endif
 
 class srcml_input_src;
+class srcml_channel;
 
 typedef std::vector<srcml_input_src> srcml_input_t;
 typedef srcml_input_src srcml_output_dest;
@@ -80,6 +82,8 @@ public:
     std::string extension;
     boost::optional<FILE*> fileptr;
     boost::optional<int> fd;
+    // in-memory connection to another step of the pipeline
+    std::shared_ptr<srcml_channel> channel;
     archive* arch;
     enum STATES state;
     std::list<std::string> compressions;
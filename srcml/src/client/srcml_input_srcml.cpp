@@ -80,11 +80,9 @@ int srcml_input_srcml(ParseQueue& queue,
     }
 
     // move to the correct unit (if needed)
-    for (int i = 1; i < (option(SRCML_COMMAND_PARSER_TEST) ? srcml_request.unit : srcml_input.unit); ++i) {
-        if (!srcml_archive_skip_unit(srcml_input_archive.get())) {
-            SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_input.unit);
-            exit(1);
-        }
+    if (!srcml_archive_skip_to_unit(srcml_input_archive.get(), option(SRCML_COMMAND_PARSER_TEST) ? srcml_request.unit : srcml_input.unit)) {
+        SRCMLstatus(ERROR_MSG, "Requested unit %s out of range.", srcml_input.unit);
+        exit(1);
     }
 
     // if we found a valid unit
@@ -107,7 +105,7 @@ int srcml_input_srcml(ParseQueue& queue,
         }
 
         // form the parsing request
-        std::shared_ptr<ParseRequest> prequest(new ParseRequest);
+        std::shared_ptr<ParseRequest> prequest(ParseRequest::create());
         prequest->srcml_arch = srcml_output_archive;
         prequest->unit.swap(unit);
         prequest->needsparsing = false;
@@ -130,6 +128,12 @@ int srcml_input_srcml(ParseQueue& queue,
             break;
     }
 
+    // input ended with an error in the srcML
+    if (srcml_archive_error_number(srcml_input_archive.get()) != SRCML_STATUS_OK) {
+        SRCMLstatus(ERROR_MSG, "Error Parsing: %s", srcml_archive_error_string(srcml_input_archive.get()));
+        return -1;
+    }
+
     if (!unitFound) {
         SRCMLstatus(ERROR_MSG, "Requested unit %d out of range.", srcml_input.unit);
         exit(1);
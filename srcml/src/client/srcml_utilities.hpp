@@ -36,6 +36,20 @@ inline void srcml_archive_deleter(srcml_archive* arch) {
     OpenFileLimiter::close();
 }
 
+// move to the unit at position unit_number (starting at 1), directly if the archive has a unit index
+inline bool srcml_archive_skip_to_unit(srcml_archive* arch, int unit_number) {
+
+    if (unit_number > 1 && srcml_archive_has_index(arch))
+        return srcml_archive_seek_unit(arch, (size_t) unit_number) == SRCML_STATUS_OK;
+
+    for (int i = 1; i < unit_number; ++i) {
+        if (!srcml_archive_skip_unit(arch))
+            return false;
+    }
+
+    return true;
+}
+
 // std::unique_ptr deleter functions for srcml
 // usage: std::unique<srcml_archive> p(srcml_archive_create());
 // Call p.get() for original pointer
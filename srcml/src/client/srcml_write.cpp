@@ -83,12 +83,10 @@ void srcml_write_request(std::shared_ptr<ParseRequest> request, TraceLog& log, c
         filename += *request->filename;
         filename += ".xml";
 
-        // create the output directory
+        // create the output directory, shared so that each directory is only created once
+        static mkDir dir;
         auto path = filename.substr(0, filename.find_last_of('/'));
-        {
-            mkDir dir;
-            dir.mkdir(path);
-        }
+        dir.mkdir(path);
 
         // call file limiter now that we are actually putting a value into cloned
         OpenFileLimiter::open();
@@ -0,0 +1,90 @@
+/**
+ * @file copy_on_write.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * Value shared between copies until one of them changes it.
+ *
+ * Used for the configuration of an archive, e.g., namespaces and registered
+ * languages, so that a clone of an archive shares the configuration of the
+ * original instead of copying it.
+ */
+
+#ifndef INCLUDED_COPY_ON_WRITE_HPP
+#define INCLUDED_COPY_ON_WRITE_HPP
+
+#include <memory>
+#include <utility>
+
+/**
+ * copy_on_write
+ *
+ * Holds a value that is shared by copies of the holder. Reads are
+ * through the const accessors. Changes are through write(), which
+ * first makes a private copy of the value if it is shared.
+ */
+template <typename T>
+class copy_on_write {
+public:
+
+    copy_on_write() : value(std::make_shared<T>()) {}
+
+    copy_on_write(const T& value) : value(std::make_shared<T>(value)) {}
+
+    copy_on_write(T&& value) : value(std::make_shared<T>(std::move(value))) {}
+
+    copy_on_write& operator=(const T& other) {
+
+        value = std::make_shared<T>(other);
+        return *this;
+    }
+
+    copy_on_write& operator=(T&& other) {
+
+        value = std::make_shared<T>(std::move(other));
+        return *this;
+    }
+
+    const T& operator*() const { return *value; }
+
+    const T* operator->() const { return value.get(); }
+
+    operator const T&() const { return *value; }
+
+    /**
+     * write
+     *
+     * Value for changes, copied first if shared with another holder.
+     *
+     * @returns the value of this holder only
+     */
+    T& write() {
+
+        if (value.use_count() > 1)
+            value = std::make_shared<T>(*value);
+
+        return *value;
+    }
+
+private:
+
+    std::shared_ptr<T> value;
+};
+
+#endif
@@ -267,6 +267,10 @@ void start_root(void* ctx, const xmlChar* localname, const xmlChar* prefix, cons
 
     state->mode = ROOT;
 
+    // whitespace before the root start tag is not part of it
+    while (IS_BLANK_CH(*state->base))
+        ++state->base;
+
     // save the root start tag because we are going to parse it again to generate proper start_root() and start_unit()
     // calls after we know whether this is an archive or not
     state->rootstarttag.reserve(ctxt->input->cur - state->base + 2);
@@ -496,19 +500,20 @@ void start_unit(void* ctx, const xmlChar* localname, const xmlChar* prefix, cons
                                             nb_namespaces, namespaces,
                                             nb_attributes, attributes);
 
-    // assuming not collecting the unit body
+    // assuming not collecting the unit body, where the characters are still needed for the LOC
     ctxt->sax->startElementNs = 0;
-    ctxt->sax->ignorableWhitespace = ctxt->sax->characters = 0;
+    ctxt->sax->ignorableWhitespace = ctxt->sax->characters = &characters_unit;
     ctxt->sax->comment = 0;
     ctxt->sax->cdataBlock = 0;
     ctxt->sax->processingInstruction = 0;
 
+    state->partial_line = false;
+
     if (!state->collect_unit_body)
         return;
 
     // next start tag will be for a non-unit element
     ctxt->sax->startElementNs = &start_element;
-    ctxt->sax->ignorableWhitespace = ctxt->sax->characters = &characters_unit;
     ctxt->sax->comment = &comment;
     ctxt->sax->cdataBlock = &cdata_block;
     ctxt->sax->processingInstruction = &processing_instruction;
@@ -773,13 +778,15 @@ void characters_unit(void* ctx, const xmlChar* ch, int len) {
 
     BASE_DEBUG;
 
+    state->loc += (int) std::count((const char*) ch, (const char*) ch + len, '\n');
+    if (len > 0)
+        state->partial_line = ch[len - 1] != '\n';
+
     if (!state->collect_unit_body)
         return;
 
     state->unitsrc.append((const char*) ch, len);
 
-    state->loc += (int) std::count((const char*) ch, (const char*) ch + len, '\n');
-
     update_ctx(ctx);
 
     // end previous start element
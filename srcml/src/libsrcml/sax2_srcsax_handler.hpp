@@ -93,6 +93,9 @@ struct sax2_srcsax_handler {
 
     int loc = 0;
 
+    /** the characters of the unit so far do not end in a newline */
+    bool partial_line = false;
+
     boost::optional<std::string> cpp_prefix;
 
     bool rootcalled = false;
@@ -22,12 +22,14 @@
 #define INCLUDED_SRCSAX_CONTROLLER_HPP
 
 class srcSAXHandler;
+class cppCallbackAdapter;
 #include <srcsax.hpp>
 
 #include <libxml/parser.h>
 #include <libxml/parserInternals.h>
 
 #include <string>
+#include <memory>
 
 /**
  * SAXError
@@ -56,6 +58,12 @@ private :
     // xmlParserCtxt
     srcsax_context* context = nullptr;
 
+    /** adapter from the srcSAX callbacks to the handler */
+    std::unique_ptr<cppCallbackAdapter> adapter;
+
+    /** srcSAX callbacks */
+    srcsax_handler sax_handler;
+
 public :
 
     /**
@@ -88,6 +96,16 @@ public :
      */
     void parse(srcSAXHandler * handler);
 
+    /**
+     * parse_chunk
+     * @param handler srcMLHandler with hooks for sax parsing
+     *
+     * Parse the next chunk of the xml document with the supplied hooks.
+     *
+     * @returns true if there is more of the document to parse
+     */
+    bool parse_chunk(srcSAXHandler * handler);
+
     /**
      * stop_parser
      *
@@ -146,6 +146,22 @@ struct srcml_archive;
  */
 struct srcml_unit;
 
+/**
+ * @struct srcml_parse_input
+ *
+ * The source code of one unit for srcml_archive_parse_batch()
+ */
+struct srcml_parse_input {
+    /** Buffer of the source code */
+    const char* buffer;
+    /** Size of the buffer */
+    size_t size;
+    /** Filename of the unit, or NULL */
+    const char* filename;
+    /** Language of the unit, or NULL to use the archive language or the filename extension */
+    const char* language;
+};
+
 /** @defgroup utility Utility functions
     @{
  */
@@ -598,6 +614,16 @@ LIBSRCML_DECL const char* srcml_archive_error_string(const struct srcml_archive*
  */
 LIBSRCML_DECL int srcml_archive_write_unit(struct srcml_archive* archive, struct srcml_unit* unit);
 
+/**
+ * Wait until all units queued by srcml_archive_write_unit() for asynchronous writes are written
+ * @param archive A srcml_archive opened for writing
+ * @note srcml_archive_close() also waits for all queued units, and records the
+ * first failed write of a queued unit as the error of the archive
+ * @return SRCML_STATUS_OK on success
+ * @return Status error code of the first failed write of a queued unit
+ */
+LIBSRCML_DECL int srcml_archive_write_flush(struct srcml_archive* archive);
+
 /**
  * Append the string to the srcml_archive archive
  * @param archive A srcml_archive opened for writing
@@ -780,6 +806,60 @@ LIBSRCML_DECL int srcml_archive_enable_hash(struct srcml_archive* archive);
  */
 LIBSRCML_DECL int srcml_archive_disable_hash(struct srcml_archive* archive);
 
+/**
+ * Whether the unit index exists (in the case of a read), or would be added (in case of a write)
+ * @param archive A srcml archive opened for reading or writing
+ * @retval 1 Will include the unit index
+ * @retval 0 Does not include the unit index
+ */
+LIBSRCML_DECL int srcml_archive_has_index(const struct srcml_archive* archive);
+
+/**
+ * Enable the unit index, written after the root unit when the archive is closed.
+ * The index records the byte offset, length, loc, hash, and filename of each unit.
+ * @param archive A srcml_archive opened for writing
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_enable_index(struct srcml_archive* archive);
+
+/**
+ * Disable the unit index. This is the default.
+ * @param archive A srcml_archive opened for writing
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_disable_index(struct srcml_archive* archive);
+
+/**
+ * Whether the archive is binary srcML (in the case of a read), or will be written as binary srcML (in case of a write)
+ * @param archive A srcml archive opened for reading or writing
+ * @retval 1 Is binary srcML
+ * @retval 0 Is XML
+ */
+LIBSRCML_DECL int srcml_archive_is_binary(const struct srcml_archive* archive);
+
+/**
+ * Write the archive as binary srcML, a compact encoding of the units for passing srcML
+ * between programs using libsrcml. Archives opened for reading detect binary srcML,
+ * and units read from it are written to an XML archive exactly as the units written to it.
+ * Binary srcML is not converted to the XML encoding of the archive, which is only recorded,
+ * so enable before the archive is opened for writing with an XML encoding.
+ * @param archive A srcml_archive opened for writing
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION if the output is already converted to the XML encoding
+ */
+LIBSRCML_DECL int srcml_archive_enable_binary(struct srcml_archive* archive);
+
+/**
+ * Write the archive as XML. This is the default.
+ * @param archive A srcml_archive opened for writing
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_disable_binary(struct srcml_archive* archive);
+
 /**
  * Set the XML encoding of the srcML archive
  * @param archive The srcml_archive to set the encoding
@@ -843,6 +923,42 @@ LIBSRCML_DECL int srcml_archive_disable_option(struct srcml_archive* archive, si
  */
 LIBSRCML_DECL int srcml_archive_set_tabstop(struct srcml_archive* archive, size_t tabstop);
 
+/**
+ * Set the time limit for parsing each unit. A unit that exceeds it is stored
+ * as its source text with the error attribute parse="timeout".
+ * For FILE and file descriptor input, which cannot be read again, a copy
+ * of the source text is kept during the parse of each unit while any limit is set
+ * @param archive A srcml_archive
+ * @param milliseconds Maximum time to parse a unit, 0 for no limit
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_set_parse_time_limit(struct srcml_archive* archive, unsigned int milliseconds);
+
+/**
+ * Set the size limit for parsing each unit. A unit that exceeds it is stored
+ * as its source text with the error attribute parse="size".
+ * For FILE and file descriptor input, which cannot be read again, a copy
+ * of the source text is kept during the parse of each unit while any limit is set
+ * @param archive A srcml_archive
+ * @param size Maximum size in bytes of a unit to parse, 0 for no limit
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_set_parse_size_limit(struct srcml_archive* archive, size_t size);
+
+/**
+ * Set the size of the queue for asynchronous writes. With a queue, srcml_archive_write_unit()
+ * queues a copy of the unit, and a background thread writes the units in order
+ * @param archive A srcml_archive
+ * @param size Maximum number of queued units, 0 for synchronous writes (default)
+ * @note A queued unit is output with the namespaces and srcDiff revision of its archive
+ * at the time of srcml_archive_write_unit()
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT
+ */
+LIBSRCML_DECL int srcml_archive_set_write_queue_size(struct srcml_archive* archive, size_t size);
+
 /**
  * Set an extension to be associated with a given source-code language
  * @param archive A srcml_archive that associates the given extension with a language
@@ -946,6 +1062,24 @@ LIBSRCML_DECL int srcml_archive_get_options(const struct srcml_archive* archive)
  */
 LIBSRCML_DECL size_t srcml_archive_get_tabstop(const struct srcml_archive* archive);
 
+/**
+ * @param archive A srcml_archive
+ * @return The time limit in milliseconds for parsing each unit, 0 for no limit
+ */
+LIBSRCML_DECL unsigned int srcml_archive_get_parse_time_limit(const struct srcml_archive* archive);
+
+/**
+ * @param archive A srcml_archive
+ * @return The size limit in bytes for parsing each unit, 0 for no limit
+ */
+LIBSRCML_DECL size_t srcml_archive_get_parse_size_limit(const struct srcml_archive* archive);
+
+/**
+ * @param archive A srcml_archive
+ * @return The maximum number of units queued for asynchronous writes, 0 for synchronous writes
+ */
+LIBSRCML_DECL size_t srcml_archive_get_write_queue_size(const struct srcml_archive* archive);
+
 /**
  * @param archive A srcml_archive
  * @return The number of currently defined namespaces or 0 if archive is NULL
@@ -992,6 +1126,15 @@ LIBSRCML_DECL const char* srcml_archive_get_processing_instruction_target(const
  */
 LIBSRCML_DECL const char* srcml_archive_get_processing_instruction_data(const struct srcml_archive* archive);
 
+/**
+ * Report of the statistics of the stages of converting the units, e.g., input, lexing,
+ * parsing, output, with counts, times, time histograms, and the slowest units to parse
+ * @param archive A srcml archive
+ * @note Statistics are only collected when libsrcml is built with STATISTICS_ENABLED
+ * @return The statistics report, valid until the next call, empty without statistics, or NULL on failure
+ */
+LIBSRCML_DECL const char* srcml_archive_get_statistics(struct srcml_archive* archive);
+
 /**
  * Retrieve the currently registered language for a file extension
  * @param archive A srcml_archive
@@ -1004,7 +1147,8 @@ LIBSRCML_DECL const char* srcml_archive_check_extension(const struct srcml_archi
 /**@{ @name Read Unit
 */
 /**
- * Read the next unit header from the archive
+ * Read the next unit header from the archive. The body of the unit is
+ * skipped, so its srcML and source are not available.
  * @param archive A srcml_archive open for reading
  * @return The read srcml_unit, with header information only, on success
  * @return NULL on failure
@@ -1012,10 +1156,11 @@ LIBSRCML_DECL const char* srcml_archive_check_extension(const struct srcml_archi
 LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit_header(struct srcml_archive* archive);
 
 /**
- * Read the next unit from the archive
+ * Read the next unit from the archive. At the end of the archive, an error in the
+ * archive input is available from srcml_archive_error_number().
  * @param archive A srcml_archive open for reading
  * @return The read srcml_unit on success
- * @return NULL on failure
+ * @return NULL on failure, or at the end of the archive
  */
 LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* archive);
 
@@ -1026,6 +1171,34 @@ LIBSRCML_DECL struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* a
  * @return NULL on failure
  */
 LIBSRCML_DECL int srcml_archive_skip_unit(struct srcml_archive* archive);
+
+/**
+ * Number of units in the archive, from the unit index
+ * @param archive A srcml_archive open for reading from a file or memory
+ * @return The number of units on success
+ * @return -1 if the archive does not have a unit index
+ */
+LIBSRCML_DECL int srcml_archive_get_unit_count(const struct srcml_archive* archive);
+
+/**
+ * Move to a unit using the unit index, without reading the preceding units
+ * @param archive A srcml_archive open for reading from a file or memory
+ * @param unit_number Position of the unit in the archive, starting at 1
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT if there is no such unit
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION if the archive does not have a unit index
+ */
+LIBSRCML_DECL int srcml_archive_seek_unit(struct srcml_archive* archive, size_t unit_number);
+
+/**
+ * Move to the first unit with a filename using the unit index, without reading the preceding units
+ * @param archive A srcml_archive open for reading from a file or memory
+ * @param filename The filename attribute of the unit
+ * @retval SRCML_STATUS_OK on success
+ * @retval SRCML_STATUS_INVALID_ARGUMENT if there is no such unit
+ * @retval SRCML_STATUS_INVALID_IO_OPERATION if the archive does not have a unit index
+ */
+LIBSRCML_DECL int srcml_archive_seek_unit_filename(struct srcml_archive* archive, const char* filename);
 /**@}*/
 
 /**@{ @name XPath query and XSLT transformations */
@@ -1490,6 +1663,34 @@ LIBSRCML_DECL int srcml_unit_parse_fd(struct srcml_unit* unit, int src_fd);
  * @return Status error code on failure.
  */
 LIBSRCML_DECL int srcml_unit_parse_io(struct srcml_unit* unit, void * context, ssize_t (*read_callback)(void * context, void * buffer, size_t len), int (*close_callback)(void * context));
+
+/**
+ * Convert the source code of each input to srcML, concurrently, into a new unit of the archive
+ * @param archive A srcml_archive for the units
+ * @param inputs Array of the source code to parse
+ * @param count Number of inputs
+ * @param threads Number of threads to parse with, 0 for the number of cores
+ * @param units Array of count units for the results in input order, NULL for a failed input
+ * @note The caller frees each unit with srcml_unit_free()
+ * @return SRCML_STATUS_OK when all inputs are parsed
+ * @return Status error code of the first failed input otherwise
+ */
+LIBSRCML_DECL int srcml_archive_parse_batch(struct srcml_archive* archive, const struct srcml_parse_input* inputs, size_t count, int threads, struct srcml_unit** units);
+
+/**
+ * Convert the source code of each input to srcML, concurrently, passing each new unit to a callback as it is completed
+ * @param archive A srcml_archive for the units
+ * @param inputs Array of the source code to parse
+ * @param count Number of inputs
+ * @param threads Number of threads to parse with, 0 for the number of cores
+ * @param context Context passed to the callback
+ * @param callback Called once for each input with its index, its unit (NULL on failure), and its status
+ * @note The callback owns the unit. Calls of the callback are not concurrent, but may be from any parsing thread.
+ * @return SRCML_STATUS_OK on success
+ * @return SRCML_STATUS_INVALID_ARGUMENT on an invalid argument
+ */
+LIBSRCML_DECL int srcml_archive_parse_batch_callback(struct srcml_archive* archive, const struct srcml_parse_input* inputs, size_t count, int threads,
+                                                     void* context, void (*callback)(void* context, size_t index, struct srcml_unit* unit, int status));
 /**@}*/
 
 /**@{ @name Convert srcML to source code
@@ -23,8 +23,12 @@
 #include <srcmlns.hpp>
 #include <srcml_translator.hpp>
 #include <srcml_sax2_reader.hpp>
+#include <srcml_binary.hpp>
+#include <srcml_async_writer.hpp>
 #include <libxml/encoding.h>
 
+#include <algorithm>
+
 /**
  * srcml_archive_check_extension
  * @param archive a srcml_archive
@@ -40,7 +44,7 @@ const char* srcml_archive_check_extension(const srcml_archive* archive, const ch
     if (archive == nullptr || filename == nullptr)
         return 0;
 
-    Language language(archive->registered_languages.get_language_from_filename(filename));
+    Language language(archive->registered_languages->get_language_from_filename(filename));
     const char* lang_string = language.getLanguageString();
     return strcmp(lang_string, "") == 0 ? 0 : lang_string;
 }
@@ -68,7 +72,7 @@ srcml_archive* srcml_archive_create() {
 
     } catch(...) { return nullptr; }
 
-    archive->registered_languages.register_standard_file_extensions();
+    archive->registered_languages.write().register_standard_file_extensions();
 
     return archive;
 }
@@ -107,6 +111,9 @@ const char* srcml_archive_error_string(const struct srcml_archive* archive) {
  */
 void srcml_archive_free(struct srcml_archive* archive) {
 
+    // finish any background writes before the translator is gone
+    archive->async_writer.reset();
+
     if (archive->translator) {
         delete archive->translator;
         archive->translator = nullptr;
@@ -126,6 +133,9 @@ void srcml_archive_free(struct srcml_archive* archive) {
         archive->reader = nullptr;
     }
 
+    delete archive->binary_reader;
+    archive->binary_reader = nullptr;
+
     if (archive == nullptr)
         return;
 
@@ -146,20 +156,31 @@ srcml_archive* srcml_archive_clone(const struct srcml_archive* archive) {
     if (archive == nullptr)
         return nullptr;
 
-    std::unique_ptr<srcml_archive> new_archive(srcml_archive_create());
-    if (!new_archive)
-        return nullptr;
+    // the configuration is shared with the original, and copied on the first change
+    std::unique_ptr<srcml_archive> new_archive;
+    try {
 
-    *new_archive = *archive;
+        new_archive.reset(new srcml_archive(*archive));
+
+    } catch(...) { return nullptr; }
 
     new_archive->type = SRCML_ARCHIVE_INVALID;
     new_archive->translator = nullptr;
     new_archive->reader = nullptr;
+    new_archive->binary_reader = nullptr;
     new_archive->output_buffer = nullptr;
     new_archive->xbuffer = nullptr;
     new_archive->buffer = nullptr;
     new_archive->size = nullptr;
     new_archive->rawwrites = false;
+    new_archive->unit_index = std::vector<unit_index_entry>();
+    new_archive->unit_index_filenames = std::unordered_map<std::string, size_t>();
+    new_archive->input_filename = boost::none;
+    new_archive->input_buffer = nullptr;
+    new_archive->input_size = 0;
+    new_archive->async_writer.reset();
+    new_archive->statistics = std::make_shared<srcml_statistics>();
+    new_archive->statistics_report.clear();
     new_archive->error_string.clear();
     new_archive->error_number = 0;
 
@@ -363,6 +384,78 @@ int srcml_archive_disable_hash(struct srcml_archive* archive) {
     return SRCML_STATUS_OK;
 }
 
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_has_index(const struct srcml_archive* archive) {
+
+    return (archive->options & SRCML_OPTION_INDEX) != 0;
+}
+
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_enable_index(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    archive->options |= (unsigned long long)(SRCML_OPTION_INDEX);
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_disable_index(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    archive->options &= ~(unsigned long long)(SRCML_OPTION_INDEX);
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_is_binary(const struct srcml_archive* archive) {
+
+    return (archive->options & SRCML_OPTION_BINARY) != 0 || archive->binary_reader != nullptr;
+}
+
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_enable_binary(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    // output already opened with a conversion to the XML encoding
+    if (archive->output_buffer && archive->output_buffer->encoder)
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    archive->options |= (unsigned long long)(SRCML_OPTION_BINARY);
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * @param archive a srcml_archive
+ */
+int srcml_archive_disable_binary(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    archive->options &= ~(unsigned long long)(SRCML_OPTION_BINARY);
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * srcml_archive_enable_option
  * @param archive a srcml_archive
@@ -431,6 +524,91 @@ int srcml_archive_set_tabstop(struct srcml_archive* archive, size_t tabstop) {
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_set_parse_time_limit
+ * @param archive a srcml_archive
+ * @param milliseconds maximum time to parse a unit, 0 for no limit
+ *
+ * Set the time limit for parsing each unit. A unit that takes longer is
+ * stopped and stored as its text with the error attribute parse="timeout".
+ *
+ * @returns SRCML_STATUS_OK on success and SRCML_STATUS_INVALID_ARGUMENT on failure.
+ */
+int srcml_archive_set_parse_time_limit(struct srcml_archive* archive, unsigned int milliseconds) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    archive->parse_time_limit = milliseconds;
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_set_parse_size_limit
+ * @param archive a srcml_archive
+ * @param size maximum size in bytes of a unit to parse, 0 for no limit
+ *
+ * Set the size limit for parsing each unit. A unit with larger input is
+ * stored as its text with the error attribute parse="size".
+ *
+ * @returns SRCML_STATUS_OK on success and SRCML_STATUS_INVALID_ARGUMENT on failure.
+ */
+int srcml_archive_set_parse_size_limit(struct srcml_archive* archive, size_t size) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    archive->parse_size_limit = size;
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_stop_async_writer
+ * @param archive a srcml_archive
+ *
+ * Write the units queued for asynchronous writes, and stop the writer. The
+ * first error in writing a unit is recorded as the error of the archive.
+ */
+static void srcml_archive_stop_async_writer(struct srcml_archive* archive) {
+
+    if (!archive->async_writer)
+        return;
+
+    int status = archive->async_writer->close();
+    archive->async_writer.reset();
+
+    if (status != SRCML_STATUS_OK) {
+        archive->error_number = status;
+        archive->error_string = "Unable to write unit";
+    }
+}
+
+/**
+ * srcml_archive_set_write_queue_size
+ * @param archive a srcml_archive
+ * @param size maximum number of units queued for writing, 0 for synchronous writes
+ *
+ * Set the size of the queue of units written on a background thread. With a queue,
+ * srcml_archive_write_unit() copies the unit into the queue and returns, and the units
+ * are written to the output in order by the background thread.
+ *
+ * @returns SRCML_STATUS_OK on success and SRCML_STATUS_INVALID_ARGUMENT on failure.
+ */
+int srcml_archive_set_write_queue_size(struct srcml_archive* archive, size_t size) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    // the next write starts a writer with the new size
+    srcml_archive_stop_async_writer(archive);
+
+    archive->write_queue_size = size;
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * srcml_archive_register_file_extension
  * @param archive a srcml_archive
@@ -446,7 +624,7 @@ int srcml_archive_register_file_extension(struct srcml_archive* archive, const c
     if (archive == nullptr || extension == nullptr || language == nullptr)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
-    if (archive->registered_languages.register_user_ext(extension, language))
+    if (archive->registered_languages.write().register_user_ext(extension, language))
         return SRCML_STATUS_OK;
 
     return SRCML_STATUS_INVALID_INPUT;
@@ -468,14 +646,16 @@ int srcml_archive_register_namespace(struct srcml_archive* archive, const char*
         return SRCML_STATUS_INVALID_ARGUMENT;
 
     // lookup by uri, if it already exists, update the prefix. If it doesn't exist, add it
-    auto& view = archive->namespaces.get<nstags::uri>();
+    // Namespaces shared with a clone are copied before the change
+    auto& namespaces = archive->namespaces.write();
+    auto& view = namespaces.get<nstags::uri>();
     auto it = view.find(uri);
     if (it != view.end()) {
         // change prefix of existing namespace
         view.modify(it, [prefix](Namespace& ns) { ns.prefix = prefix; });
     } else {
         // add new namespace
-        archive->namespaces.push_back({ prefix, uri, NS_REGISTERED });
+        namespaces.push_back({ prefix, uri, NS_REGISTERED });
     }
 
     // namespaces for options enable the options automatically
@@ -537,18 +717,18 @@ int srcml_archive_register_macro(struct srcml_archive* archive, const char* toke
 
     try {
 
-        std::vector<std::string>::size_type user_macro_list_size = archive->user_macro_list.size() / 2;
+        std::vector<std::string>::size_type user_macro_list_size = archive->user_macro_list->size() / 2;
         for(std::vector<std::string>::size_type i = 0; i < user_macro_list_size; ++i)
-            if (archive->user_macro_list.at(i * 2) == token) {
+            if (archive->user_macro_list->at(i * 2) == token) {
 
-                archive->user_macro_list.at(i * 2 + 1) = type;
+                archive->user_macro_list.write().at(i * 2 + 1) = type;
                 return SRCML_STATUS_OK;
             }
 
     } catch(...) { return SRCML_STATUS_ERROR; }
 
-    archive->user_macro_list.push_back(token);
-    archive->user_macro_list.push_back(type);
+    archive->user_macro_list.write().push_back(token);
+    archive->user_macro_list.write().push_back(type);
 
     return SRCML_STATUS_OK;
 }
@@ -668,6 +848,39 @@ size_t srcml_archive_get_tabstop(const struct srcml_archive* archive) {
     return archive ? archive->tabstop : 0;
 }
 
+/**
+ * srcml_archive_get_parse_time_limit
+ * @param archive a srcml_archive
+ *
+ * @returns Retrieve the time limit in milliseconds for parsing each unit, 0 for no limit.
+ */
+unsigned int srcml_archive_get_parse_time_limit(const struct srcml_archive* archive) {
+
+    return archive ? archive->parse_time_limit : 0;
+}
+
+/**
+ * srcml_archive_get_write_queue_size
+ * @param archive a srcml_archive
+ *
+ * @returns Retrieve the maximum number of units queued for writing, 0 for synchronous writes.
+ */
+size_t srcml_archive_get_write_queue_size(const struct srcml_archive* archive) {
+
+    return archive ? archive->write_queue_size : 0;
+}
+
+/**
+ * srcml_archive_get_parse_size_limit
+ * @param archive a srcml_archive
+ *
+ * @returns Retrieve the size limit in bytes for parsing each unit, 0 for no limit.
+ */
+size_t srcml_archive_get_parse_size_limit(const struct srcml_archive* archive) {
+
+    return archive ? archive->parse_size_limit : 0;
+}
+
 /**
  * srcml_archive_get_namespace_size
  * @param archive a srcml_archive
@@ -676,7 +889,7 @@ size_t srcml_archive_get_tabstop(const struct srcml_archive* archive) {
  */
 size_t srcml_archive_get_namespace_size(const struct srcml_archive* archive) {
 
-    return archive ? archive->namespaces.size() : 0;
+    return archive ? archive->namespaces->size() : 0;
 }
 
 /**
@@ -692,10 +905,10 @@ const char* srcml_archive_get_namespace_prefix(const struct srcml_archive* archi
     if (archive == nullptr)
         return nullptr;
 
-    if (pos > archive->namespaces.size())
+    if (pos > archive->namespaces->size())
         return nullptr;
 
-    return archive->namespaces[pos].prefix.c_str();
+    return (*archive->namespaces)[pos].prefix.c_str();
 }
 
 /**
@@ -711,7 +924,7 @@ const char* srcml_archive_get_prefix_from_uri(const struct srcml_archive* archiv
     if (archive == nullptr || uri == nullptr)
         return 0;
 
-    const auto& view = archive->namespaces.get<nstags::uri>();
+    const auto& view = archive->namespaces->get<nstags::uri>();
     const auto it = view.find(uri);
 
     return it != view.end() ? it->prefix.c_str() : 0;
@@ -730,10 +943,10 @@ const char* srcml_archive_get_namespace_uri(const struct srcml_archive* archive,
     if (archive == nullptr)
         return nullptr;
 
-    if (pos >= archive->namespaces.size())
+    if (pos >= archive->namespaces->size())
         return nullptr;
 
-    return archive->namespaces[pos].uri.c_str();
+    return (*archive->namespaces)[pos].uri.c_str();
 }
 
 /**
@@ -749,7 +962,7 @@ const char* srcml_archive_get_uri_from_prefix(const struct srcml_archive* archiv
     if (archive == nullptr || prefix == nullptr)
         return 0;
 
-    const auto& view = archive->namespaces.get<nstags::prefix>();
+    const auto& view = archive->namespaces->get<nstags::prefix>();
     const auto& it = view.find(prefix);
 
     return it != view.end() ? it->uri.c_str() : 0;
@@ -777,6 +990,32 @@ const char* srcml_archive_get_processing_instruction_data(const struct srcml_arc
     return archive->processing_instruction ?  archive->processing_instruction->second.c_str() : 0;
 }
 
+/**
+ * srcml_archive_get_statistics
+ * @param archive a srcml_archive
+ *
+ * Report of the counts, times, and time histograms of the stages of the
+ * pipeline, e.g., input, lexing, parsing, and output, for all the units
+ * of the archive, along with the slowest units to parse.
+ *
+ * @returns the statistics report, valid until the next call, empty if libsrcml is
+ * built without statistics, or 0 if archive is NULL
+ */
+const char* srcml_archive_get_statistics(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return 0;
+
+    // without statistics in the build there is nothing to report
+#ifndef NO_SRCML_STATISTICS
+    archive->statistics_report = archive->statistics->report();
+#else
+    archive->statistics_report.clear();
+#endif
+
+    return archive->statistics_report.c_str();
+}
+
 /**
  * srcml_archive_get_macro_list_size
  * @param archive a srcml_archive
@@ -785,7 +1024,7 @@ const char* srcml_archive_get_processing_instruction_data(const struct srcml_arc
  */
 size_t srcml_archive_get_macro_list_size(const struct srcml_archive* archive) {
 
-    return archive ? (archive->user_macro_list.size() / 2) : 0;
+    return archive ? (archive->user_macro_list->size() / 2) : 0;
 }
 
 /**
@@ -801,10 +1040,10 @@ const char* srcml_archive_get_macro_token(const struct srcml_archive* archive, s
     if (archive == nullptr)
         return 0;
 
-    if (pos * 2 >= archive->user_macro_list.size())
+    if (pos * 2 >= archive->user_macro_list->size())
         return 0;
 
-    return archive->user_macro_list[pos * 2].c_str();
+    return (*archive->user_macro_list)[pos * 2].c_str();
 }
 
 /**
@@ -822,10 +1061,10 @@ const char* srcml_archive_get_macro_token_type(const struct srcml_archive* archi
 
     try {
 
-        std::vector<std::string>::size_type user_macro_list_size = archive->user_macro_list.size() / 2;
+        std::vector<std::string>::size_type user_macro_list_size = archive->user_macro_list->size() / 2;
         for(std::vector<std::string>::size_type i = 0;  user_macro_list_size; ++i)
-            if (archive->user_macro_list.at(i * 2) == token)
-                return archive->user_macro_list.at(i * 2 + 1).c_str();
+            if (archive->user_macro_list->at(i * 2) == token)
+                return archive->user_macro_list->at(i * 2 + 1).c_str();
 
     } catch(...) {}
 
@@ -845,10 +1084,10 @@ const char* srcml_archive_get_macro_type(const struct srcml_archive* archive, si
     if (archive == nullptr)
         return 0;
 
-    if (pos * 2 + 1 >= archive->user_macro_list.size())
+    if (pos * 2 + 1 >= archive->user_macro_list->size())
         return 0;
 
-    return archive->user_macro_list[pos * 2 + 1].c_str();
+    return (*archive->user_macro_list)[pos * 2 + 1].c_str();
 }
 
 /**
@@ -902,6 +1141,23 @@ static int srcml_archive_write_create_translator_xml_buffer(struct srcml_archive
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_output_encoder
+ * @param archive a srcml_archive
+ *
+ * Conversion of the output to the XML encoding of the archive. Binary srcML
+ * is written as is.
+ *
+ * @returns the encoding handler, or 0 for no conversion
+ */
+static xmlCharEncodingHandlerPtr srcml_archive_output_encoder(const struct srcml_archive* archive) {
+
+    if (archive->options & SRCML_OPTION_BINARY)
+        return 0;
+
+    return xmlFindCharEncodingHandler(archive->encoding ? archive->encoding->c_str() : 0);
+}
+
 /**
  * srcml_archive_write_open_filename
  * @param archive a srcml_archive
@@ -968,7 +1224,7 @@ int srcml_archive_write_open_FILE(struct srcml_archive* archive, FILE* srcml_fil
 
     archive->type = SRCML_ARCHIVE_WRITE;
 
-    archive->output_buffer = xmlOutputBufferCreateFile(srcml_file, xmlFindCharEncodingHandler(archive->encoding ? archive->encoding->c_str() : 0));
+    archive->output_buffer = xmlOutputBufferCreateFile(srcml_file, srcml_archive_output_encoder(archive));
 
     return SRCML_STATUS_OK;
 }
@@ -990,7 +1246,7 @@ int srcml_archive_write_open_fd(struct srcml_archive* archive, int srcml_fd) {
 
     archive->type = SRCML_ARCHIVE_WRITE;
 
-    archive->output_buffer = xmlOutputBufferCreateFd(srcml_fd, xmlFindCharEncodingHandler(archive->encoding ? archive->encoding->c_str() : 0));
+    archive->output_buffer = xmlOutputBufferCreateFd(srcml_fd, srcml_archive_output_encoder(archive));
 
     return SRCML_STATUS_OK;
 }
@@ -1015,7 +1271,7 @@ int srcml_archive_write_open_io(struct srcml_archive* archive, void * context, i
 
     archive->type = SRCML_ARCHIVE_WRITE;
 
-    archive->output_buffer = xmlOutputBufferCreateIO(write_callback, close_callback, context, xmlFindCharEncodingHandler(archive->encoding ? archive->encoding->c_str() : 0));
+    archive->output_buffer = xmlOutputBufferCreateIO(write_callback, close_callback, context, srcml_archive_output_encoder(archive));
 
     return SRCML_STATUS_OK;
 }
@@ -1032,16 +1288,26 @@ int srcml_archive_write_open_io(struct srcml_archive* archive, void * context, i
  *
  * Function used internally to the srcml_archive_read_open_* functions.
  * Reads and sets the open type as well as gathers the attributes
- * and sets the options from the opened srcML Archive.
+ * and sets the options from the opened srcML Archive. Binary srcML
+ * is detected from the start of the input.
  */
 static int srcml_archive_read_open_internal(struct srcml_archive* archive, std::unique_ptr<xmlParserInputBuffer> input) {
 
     if (!input)
         return SRCML_STATUS_IO_ERROR;
 
+    delete archive->binary_reader;
+    archive->binary_reader = nullptr;
+
+    archive->error_number = SRCML_STATUS_OK;
+    archive->error_string.clear();
+
     try {
 
-        archive->reader = new srcml_sax2_reader(archive, std::move(input));
+        if (srcml_binary_reader::is_binary(input.get()))
+            archive->binary_reader = new srcml_binary_reader(archive, std::move(input));
+        else
+            archive->reader = new srcml_sax2_reader(archive, std::move(input));
 
     } catch(...) {
 
@@ -1053,6 +1319,34 @@ static int srcml_archive_read_open_internal(struct srcml_archive* archive, std::
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_read_index
+ * @param archive a srcml_archive
+ * @param found if the archive input has a unit index
+ *
+ * Record if the opened archive has a unit index.  Solitary units
+ * do not have one.
+ */
+static void srcml_archive_read_index(struct srcml_archive* archive, bool found) {
+
+    if (found && (archive->options & SRCML_OPTION_ARCHIVE)) {
+        archive->options |= SRCML_OPTION_INDEX;
+
+        // only the first unit with a filename is reached by filename
+        std::unordered_map<std::string, size_t>& filenames = archive->unit_index_filenames.write();
+        filenames.clear();
+        for (size_t i = 0; i < archive->unit_index->size(); ++i)
+            filenames.emplace((*archive->unit_index)[i].filename, i);
+    } else {
+        archive->options &= ~SRCML_OPTION_INDEX;
+        archive->unit_index.write().clear();
+        archive->unit_index_filenames.write().clear();
+        archive->input_filename = boost::none;
+        archive->input_buffer = nullptr;
+        archive->input_size = 0;
+    }
+}
+
 /**
  * srcml_archive_read_open_filename
  * @param archive a srcml_archive
@@ -1070,7 +1364,14 @@ int srcml_archive_read_open_filename(struct srcml_archive* archive, const char*
 
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateFilename(srcml_filename, archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE));
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    archive->input_filename = std::string(srcml_filename);
+    srcml_archive_read_index(archive, unit_index_read_filename(srcml_filename, archive->unit_index.write()));
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -1089,7 +1390,9 @@ int srcml_archive_read_open_memory(struct srcml_archive* archive, const char* bu
     if (archive == nullptr || buffer == nullptr || buffer_size <= 0)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
-    xmlCharEncoding encoding = archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE;
+    // binary srcML is not converted from the encoding
+    xmlCharEncoding encoding = archive->encoding && !srcml_binary_reader::is_binary(buffer, buffer_size) ?
+                               xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE;
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateMem(buffer, (int)buffer_size, encoding));
 
     // buffer stuff
@@ -1114,7 +1417,15 @@ int srcml_archive_read_open_memory(struct srcml_archive* archive, const char* bu
         xmlParserInputBufferGrow(input.get(), buffer_size > 4096 ? (int)buffer_size : 4096);
     }
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    archive->input_buffer = buffer;
+    archive->input_size = buffer_size;
+    srcml_archive_read_index(archive, unit_index_read_memory(buffer, buffer_size, archive->unit_index.write()));
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -1134,7 +1445,13 @@ int srcml_archive_read_open_FILE(struct srcml_archive* archive, FILE* srcml_file
 
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateFile(srcml_file, archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE));
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    srcml_archive_read_index(archive, false);
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -1154,7 +1471,13 @@ int srcml_archive_read_open_fd(struct srcml_archive* archive, int srcml_fd) {
 
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateFd(srcml_fd, archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE));
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    srcml_archive_read_index(archive, false);
+
+    return SRCML_STATUS_OK;
 }
 
 /**
@@ -1176,7 +1499,13 @@ int srcml_archive_read_open_io(struct srcml_archive* archive, void * context, in
 
     std::unique_ptr<xmlParserInputBuffer> input(xmlParserInputBufferCreateIO(read_callback, close_callback, context, archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE));
 
-    return srcml_archive_read_open_internal(archive, std::move(input));
+    int status = srcml_archive_read_open_internal(archive, std::move(input));
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    srcml_archive_read_index(archive, false);
+
+    return SRCML_STATUS_OK;
 }
 
 /******************************************************************************
@@ -1223,11 +1552,42 @@ int srcml_archive_write_unit(struct srcml_archive* archive, struct srcml_unit* u
             return status;
     }
 
+    // with asynchronous writes, the background writer gets its own copy of the unit
+    if (archive->write_queue_size) {
+
+        if (!archive->async_writer)
+            archive->async_writer = std::make_shared<srcml_async_writer>(archive, archive->write_queue_size);
+
+        return archive->async_writer->write(unit);
+    }
+
+    SRCML_STATISTICS(srcml_statistics_timer timer(archive->statistics.get(), SRCML_STAGE_OUTPUT, unit->srcml.size());)
+
     archive->translator->add_unit(unit);
 
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_write_flush
+ * @param archive a srcml archive opened for writing
+ *
+ * Wait until all units queued by srcml_archive_write_unit() are written.
+ * Without asynchronous writes, units are already written.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_write_flush(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (archive->async_writer)
+        return archive->async_writer->flush();
+
+    return SRCML_STATUS_OK;
+}
+
 /**
  * srcml_archive_write
  * @param archive a srcml archive opened for writing
@@ -1246,6 +1606,13 @@ int srcml_archive_write_string(struct srcml_archive* archive, const char* s, int
     if (archive == nullptr || s == nullptr || len < 0)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
+    // raw writes follow any queued units
+    if (archive->async_writer) {
+        int status = archive->async_writer->flush();
+        if (status != SRCML_STATUS_OK)
+            return status;
+    }
+
     if (archive->output_buffer)
         xmlOutputBufferWrite(archive->output_buffer, len, s);
 
@@ -1254,6 +1621,37 @@ int srcml_archive_write_string(struct srcml_archive* archive, const char* s, int
     return SRCML_STATUS_OK;
 }
 
+/**
+ * srcml_archive_read_unit_header
+ * @param archive a srcml archive open for reading
+ *
+ * Read the header of the next unit from the archive.
+ * The body of the unit is skipped without being collected,
+ * so the srcML and source of the unit are not available.
+ *
+ * @returns Return the read srcml_unit on success.
+ * On failure returns NULL.
+ */
+struct srcml_unit* srcml_archive_read_unit_header(struct srcml_archive* archive) {
+
+    if (archive == nullptr)
+        return nullptr;
+
+    if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
+        return nullptr;
+
+    std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
+
+    // binary srcML units are read completely
+    if (archive->binary_reader)
+        return archive->binary_reader->read_unit(unit.get()) ? unit.release() : nullptr;
+
+    if (!archive->reader->read_header(unit.get(), false))
+        return nullptr;
+
+    return unit.release();
+}
+
 /**
  * srcml_archive_read_unit
  * @param archive a srcml archive open for reading
@@ -1274,6 +1672,11 @@ struct srcml_unit* srcml_archive_read_unit(struct srcml_archive* archive) {
         return nullptr;
 
     std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
+
+    // binary srcML units are read completely
+    if (archive->binary_reader)
+        return archive->binary_reader->read_unit(unit.get()) ? unit.release() : nullptr;
+
     int not_done = 0;
     if (!unit->read_header)
         not_done = archive->reader->read_header(unit.get());
@@ -1307,7 +1710,11 @@ int srcml_archive_skip_unit(struct srcml_archive* archive) {
     // read the header only of a temporary unit
     std::unique_ptr<srcml_unit> unit(srcml_unit_create(archive));
 
-    int not_done = archive->reader->read_header(unit.get());
+    if (archive->binary_reader)
+        return archive->binary_reader->read_unit(unit.get()) ? 1 : 0;
+
+    // the body of a skipped unit is not collected
+    int not_done = archive->reader->read_header(unit.get(), false);
     if (!not_done) {
         return 0;
     }
@@ -1315,6 +1722,105 @@ int srcml_archive_skip_unit(struct srcml_archive* archive) {
     return 1;
 }
 
+/**
+ * srcml_archive_get_unit_count
+ * @param archive a srcml archive open for reading
+ *
+ * Number of units in the archive, from the unit index.
+ *
+ * @returns the number of units, or -1 if the archive does not have a unit index.
+ */
+int srcml_archive_get_unit_count(const struct srcml_archive* archive) {
+
+    if (archive == nullptr || !(archive->options & SRCML_OPTION_INDEX))
+        return -1;
+
+    if (archive->type != SRCML_ARCHIVE_READ && archive->type != SRCML_ARCHIVE_RW)
+        return -1;
+
+    return (int) archive->unit_index->size();
+}
+
+/**
+ * srcml_archive_read_seek_internal
+ * @param archive a srcml archive open for reading with a unit index
+ * @param entry the unit index entry of the unit to read next
+ *
+ * Restart the reading of the archive at the unit, without reading the
+ * preceding units.  The archive up to the first unit is read again, so
+ * the unit is read as if it were the first unit of the archive.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+static int srcml_archive_read_seek_internal(struct srcml_archive* archive, const unit_index_entry& entry) {
+
+    xmlCharEncoding encoding = archive->encoding ? xmlParseCharEncoding(archive->encoding->c_str()) : XML_CHAR_ENCODING_NONE;
+    unsigned long long first_offset = archive->unit_index->front().offset;
+
+    std::unique_ptr<xmlParserInputBuffer> input(archive->input_filename ?
+        unit_index_input_filename(archive->input_filename->c_str(), first_offset, entry.offset, encoding) :
+        unit_index_input_memory(archive->input_buffer, archive->input_size, first_offset, entry.offset, encoding));
+    if (!input)
+        return SRCML_STATUS_IO_ERROR;
+
+    delete archive->reader;
+    archive->reader = nullptr;
+
+    // root attributes are collected again
+    archive->attributes.write().clear();
+
+    return srcml_archive_read_open_internal(archive, std::move(input));
+}
+
+/**
+ * srcml_archive_seek_unit
+ * @param archive a srcml archive open for reading
+ * @param unit_number position of the unit in the archive, starting at 1
+ *
+ * Move directly to a unit using the unit index, so that the next
+ * unit read is the one at unit_number.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_seek_unit(struct srcml_archive* archive, size_t unit_number) {
+
+    if (archive == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (archive->type != SRCML_ARCHIVE_READ || !(archive->options & SRCML_OPTION_INDEX))
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    if (unit_number < 1 || unit_number > archive->unit_index->size())
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    return srcml_archive_read_seek_internal(archive, (*archive->unit_index)[unit_number - 1]);
+}
+
+/**
+ * srcml_archive_seek_unit_filename
+ * @param archive a srcml archive open for reading
+ * @param filename the filename attribute of the unit
+ *
+ * Move directly to the first unit with the filename using the unit index,
+ * so that the next unit read is that unit.
+ *
+ * @returns Return SRCML_STATUS_OK on success and a status error code on failure.
+ */
+int srcml_archive_seek_unit_filename(struct srcml_archive* archive, const char* filename) {
+
+    if (archive == nullptr || filename == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (archive->type != SRCML_ARCHIVE_READ || !(archive->options & SRCML_OPTION_INDEX))
+        return SRCML_STATUS_INVALID_IO_OPERATION;
+
+    auto it = archive->unit_index_filenames->find(filename);
+    if (it == archive->unit_index_filenames->end())
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    return srcml_archive_read_seek_internal(archive, (*archive->unit_index)[it->second]);
+}
+
 /******************************************************************************
  *                                                                            *
  *                       Archive close function                               *
@@ -1334,6 +1840,9 @@ void srcml_archive_close(struct srcml_archive* archive) {
     if (archive == nullptr)
         return;
 
+    // write any queued units before the end of the archive
+    srcml_archive_stop_async_writer(archive);
+
     // if we haven't opened the translator yet, do so now. This will create an empty unit/archive
     if (archive->type == SRCML_ARCHIVE_WRITE && !archive->rawwrites && archive->translator == nullptr) {
         srcml_archive_write_create_translator_xml_buffer(archive);
@@ -1356,5 +1865,11 @@ void srcml_archive_close(struct srcml_archive* archive) {
         (*archive->buffer) = (char *) xmlBufferDetach(archive->xbuffer);
     }
 
+    archive->unit_index.write().clear();
+    archive->unit_index_filenames.write().clear();
+    archive->input_filename = boost::none;
+    archive->input_buffer = nullptr;
+    archive->input_size = 0;
+
     archive->type = SRCML_ARCHIVE_INVALID;
 }
@@ -0,0 +1,202 @@
+/**
+ * @file srcml_async_writer.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <srcml_async_writer.hpp>
+#include <srcml_translator.hpp>
+
+/**
+ * srcml_async_writer
+ * @param archive the archive to write the units of
+ * @param capacity maximum number of queued units
+ *
+ * Constructor. Starts the writer thread.
+ */
+srcml_async_writer::srcml_async_writer(srcml_archive* archive, size_t capacity)
+    : archive(archive), capacity(capacity ? capacity : 1) {
+
+    writer = std::thread(&srcml_async_writer::run, this);
+}
+
+/**
+ * ~srcml_async_writer
+ *
+ * Destructor. Writes any queued units, then stops the writer thread.
+ */
+srcml_async_writer::~srcml_async_writer() {
+
+    close();
+}
+
+/**
+ * snapshot_of
+ * @param unit_archive the archive of a unit to queue
+ *
+ * Snapshot of the archive state used for output of the unit. The snapshot is
+ * a clone, so shares the namespaces with the archive until one of them changes.
+ *
+ * @returns the snapshot, or null if the archive cannot be cloned
+ */
+std::shared_ptr<srcml_archive> srcml_async_writer::snapshot_of(srcml_archive* unit_archive) {
+
+    // a change of the namespaces makes a new copy, so sharing them means unchanged
+    if (!snapshot || snapshot_source != unit_archive
+        || &*snapshot->namespaces != &*unit_archive->namespaces
+        || snapshot->revision_number != unit_archive->revision_number) {
+
+        snapshot.reset(srcml_archive_clone(unit_archive), srcml_archive_free);
+        snapshot_source = unit_archive;
+    }
+
+    return snapshot;
+}
+
+/**
+ * write
+ * @param unit the unit to write
+ *
+ * Queue a copy of the parts of the unit needed for output, waiting while the
+ * queue is full.
+ *
+ * @returns SRCML_STATUS_OK on success, or the error of an earlier write
+ */
+int srcml_async_writer::write(const srcml_unit* unit) {
+
+    std::shared_ptr<srcml_archive> unit_snapshot = snapshot_of(unit->archive);
+    if (!unit_snapshot)
+        return SRCML_STATUS_ERROR;
+
+    // the source, and other forms of the srcML, are not output
+    std::unique_ptr<srcml_unit> copy(new srcml_unit);
+    copy->archive = unit_snapshot.get();
+    copy->encoding = unit->encoding;
+    copy->revision = unit->revision;
+    copy->language = unit->language;
+    copy->filename = unit->filename;
+    copy->url = unit->url;
+    copy->version = unit->version;
+    copy->timestamp = unit->timestamp;
+    copy->hash = unit->hash;
+    copy->attributes = unit->attributes;
+    copy->derived_language = unit->derived_language;
+    copy->namespaces = unit->namespaces;
+    copy->read_header = unit->read_header;
+    copy->read_body = unit->read_body;
+    copy->has_body = unit->has_body;
+    copy->srcml = unit->srcml;
+    copy->content_begin = unit->content_begin;
+    copy->content_end = unit->content_end;
+    copy->insert_begin = unit->insert_begin;
+    copy->insert_end = unit->insert_end;
+    copy->loc = unit->loc;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return units.size() < capacity || status != SRCML_STATUS_OK; });
+
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    units.emplace_back(std::move(copy), std::move(unit_snapshot));
+    changed.notify_all();
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * flush
+ *
+ * Wait until all queued units are written to the translator.
+ *
+ * @returns SRCML_STATUS_OK on success, or the error of the first failed write
+ */
+int srcml_async_writer::flush() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]() { return units.empty() && !writing; });
+
+    return status;
+}
+
+/**
+ * close
+ *
+ * Write any queued units, then stop the writer thread.
+ *
+ * @returns SRCML_STATUS_OK on success, or the error of the first failed write
+ */
+int srcml_async_writer::close() {
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+
+    if (writer.joinable())
+        writer.join();
+
+    return status;
+}
+
+/**
+ * run
+ *
+ * Write units in queue order until stopped and the queue is empty.
+ * After the first error, queued units are dropped.
+ */
+void srcml_async_writer::run() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+
+        changed.wait(lock, [this]() { return !units.empty() || stopping; });
+        if (units.empty())
+            return;
+
+        auto entry = std::move(units.front());
+        units.pop_front();
+        if (status != SRCML_STATUS_OK) {
+            changed.notify_all();
+            continue;
+        }
+        writing = true;
+        changed.notify_all();
+        lock.unlock();
+
+        int result = SRCML_STATUS_OK;
+        try {
+
+            SRCML_STATISTICS(srcml_statistics_timer timer(archive->statistics.get(), SRCML_STAGE_OUTPUT, entry.first->srcml.size());)
+
+            if (!archive->translator->add_unit(entry.first.get()))
+                result = SRCML_STATUS_INVALID_IO_OPERATION;
+
+        } catch (...) {
+            result = SRCML_STATUS_ERROR;
+        }
+        entry.first.reset();
+        entry.second.reset();
+
+        lock.lock();
+        if (status == SRCML_STATUS_OK)
+            status = result;
+        writing = false;
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file srcml_async_writer.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef INCLUDED_SRCML_ASYNC_WRITER_HPP
+#define INCLUDED_SRCML_ASYNC_WRITER_HPP
+
+#include <srcml_types.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * srcml_async_writer
+ *
+ * Writes units to the translator of an archive on a background thread, so
+ * serialization, compression, and output do not block the caller. The queue
+ * of units is bounded, and a write blocks while it is full.
+ *
+ * A queued unit has only the parts needed for output, and its archive is a
+ * snapshot of the archive state used for output, i.e., namespaces and srcDiff
+ * revision, taken when the unit is queued. The writer thread never reads
+ * anything the caller can change. The first error in writing a unit ends
+ * the writes, and is the result of later writes, flush, and close.
+ */
+class srcml_async_writer {
+public:
+
+    // start the writer thread for the archive
+    srcml_async_writer(srcml_archive* archive, size_t capacity);
+
+    // write the queued units and stop the writer thread
+    ~srcml_async_writer();
+
+    // queue a copy of a unit for writing
+    int write(const srcml_unit* unit);
+
+    // wait until all queued units are written
+    int flush();
+
+    // write the queued units and stop the writer thread
+    int close();
+
+private:
+    void run();
+
+    std::shared_ptr<srcml_archive> snapshot_of(srcml_archive* unit_archive);
+
+    srcml_archive* archive;
+    size_t capacity;
+
+    // snapshot of the archive of the last queued unit, reused while unchanged
+    srcml_archive* snapshot_source = nullptr;
+    std::shared_ptr<srcml_archive> snapshot;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::pair<std::unique_ptr<srcml_unit>, std::shared_ptr<srcml_archive>>> units;
+    bool writing = false;
+    bool stopping = false;
+    int status = SRCML_STATUS_OK;
+
+    std::thread writer;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file srcml_batch.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <srcml.h>
+#include <srcml_types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * parse_input
+     * @param archive the archive of the unit
+     * @param input the source code to parse
+     * @param status the status of the parse
+     *
+     * Create a unit and parse the input into it.
+     *
+     * @returns the parsed unit, or 0 on failure with the status set
+     */
+    srcml_unit* parse_input(srcml_archive* archive, const srcml_parse_input& input, int& status) {
+
+        srcml_unit* unit = srcml_unit_create(archive);
+        if (!unit) {
+            status = SRCML_STATUS_ERROR;
+            return 0;
+        }
+
+        if (input.filename)
+            srcml_unit_set_filename(unit, input.filename);
+
+        // srcml_unit_parse_memory() has no filename to find the language from
+        const char* language = input.language;
+        if (!language && input.filename && !archive->language)
+            language = srcml_archive_check_extension(archive, input.filename);
+
+        if (language)
+            srcml_unit_set_language(unit, language);
+
+        status = srcml_unit_parse_memory(unit, input.buffer, input.size);
+        if (status != SRCML_STATUS_OK) {
+            srcml_unit_free(unit);
+            return 0;
+        }
+
+        return unit;
+    }
+}
+
+/**
+ * srcml_archive_parse_batch_callback
+ * @param archive a srcml archive
+ * @param inputs the source code to parse
+ * @param count the number of inputs
+ * @param threads the number of threads to parse with, 0 for the number of cores
+ * @param context passed to the callback
+ * @param callback called with each parsed unit
+ *
+ * Parse the inputs concurrently into units of the archive. The callback is called
+ * once for each input, with its index, as it is completed, so not necessarily in
+ * input order. Calls of the callback are never concurrent, but may be from any of the
+ * parsing threads. The callback owns the unit, which is 0 when the parse failed.
+ *
+ * @returns SRCML_STATUS_OK on success and SRCML_STATUS_INVALID_ARGUMENT on an invalid argument.
+ */
+int srcml_archive_parse_batch_callback(struct srcml_archive* archive, const struct srcml_parse_input* inputs, size_t count, int threads,
+                                       void* context, void (*callback)(void* context, size_t index, struct srcml_unit* unit, int status)) {
+
+    if (archive == nullptr || (count && inputs == nullptr) || callback == nullptr || threads < 0)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    if (threads == 0)
+        threads = std::max(1, (int) std::thread::hardware_concurrency());
+    if ((size_t) threads > count)
+        threads = (int) std::max<size_t>(1, count);
+
+    std::atomic<size_t> next(0);
+    std::mutex callback_mutex;
+
+    // each thread takes the next input until none are left
+    auto parser = [&]() {
+
+        for (size_t index = next++; index < count; index = next++) {
+
+            int status = SRCML_STATUS_OK;
+            srcml_unit* unit = parse_input(archive, inputs[index], status);
+
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            callback(context, index, unit, status);
+        }
+    };
+
+    // the calling thread is one of the parsing threads
+    std::vector<std::thread> parsers;
+    for (int i = 1; i < threads; ++i)
+        parsers.emplace_back(parser);
+    parser();
+    for (auto& thread : parsers)
+        thread.join();
+
+    return SRCML_STATUS_OK;
+}
+
+/**
+ * srcml_archive_parse_batch
+ * @param archive a srcml archive
+ * @param inputs the source code to parse
+ * @param count the number of inputs
+ * @param threads the number of threads to parse with, 0 for the number of cores
+ * @param units array of count units for the results, in input order
+ *
+ * Parse the inputs concurrently into units of the archive. The caller owns the
+ * resulting units, and frees them with srcml_unit_free(). The unit of an input
+ * that failed to parse is 0.
+ *
+ * @returns SRCML_STATUS_OK when all inputs were parsed, otherwise the status
+ * of the first input that failed.
+ */
+int srcml_archive_parse_batch(struct srcml_archive* archive, const struct srcml_parse_input* inputs, size_t count, int threads,
+                              struct srcml_unit** units) {
+
+    if (units == nullptr)
+        return SRCML_STATUS_INVALID_ARGUMENT;
+
+    struct batch_result {
+        srcml_unit** units;
+        std::vector<int> statuses;
+    } result = { units, std::vector<int>(count, SRCML_STATUS_OK) };
+
+    int status = srcml_archive_parse_batch_callback(archive, inputs, count, threads, &result,
+        [](void* context, size_t index, srcml_unit* unit, int status) {
+
+            auto result = (batch_result*) context;
+            result->units[index] = unit;
+            result->statuses[index] = status;
+        });
+    if (status != SRCML_STATUS_OK)
+        return status;
+
+    for (auto unit_status : result.statuses)
+        if (unit_status != SRCML_STATUS_OK)
+            return unit_status;
+
+    return SRCML_STATUS_OK;
+}
@@ -0,0 +1,630 @@
+/**
+ * @file srcml_binary.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <srcml_binary.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+    /** start of binary srcML */
+    const char BINARY_MAGIC[] = { '\0', 's', 'r', 'c', 'M', 'L', 'b', '1' };
+    const size_t BINARY_MAGIC_SIZE = sizeof(BINARY_MAGIC);
+
+    /** record types */
+    const unsigned char BINARY_END  = 0;
+    const unsigned char BINARY_UNIT = 1;
+
+    /** size to grow the input by */
+    const int BINARY_CHUNK_SIZE = 64 * 1024;
+}
+
+/**
+ * write_header
+ * @param xml_encoding the xml encoding of the archive
+ * @param revision the srcML revision
+ * @param language the archive language
+ * @param url the archive url
+ * @param version the archive version
+ * @param options the archive options
+ * @param tabstop the archive tabstop
+ * @param processing_instruction the processing instruction before the root
+ * @param attributes other root attributes
+ * @param namespaces the archive namespaces
+ * @param macros user defined macros as token and type pairs
+ *
+ * Write the magic and the header record of the archive.
+ */
+void srcml_binary_writer::write_header(const char* xml_encoding, const char* revision, const char* language, const char* url, const char* version,
+                                       OPTION_TYPE options, size_t tabstop,
+                                       const boost::optional<std::pair<std::string, std::string>>& processing_instruction,
+                                       const std::vector<std::string>& attributes, const Namespaces& namespaces,
+                                       const std::vector<std::string>& macros) {
+
+    xmlOutputBufferWrite(output, (int) BINARY_MAGIC_SIZE, BINARY_MAGIC);
+
+    record.clear();
+
+    optional_string(xml_encoding);
+    optional_string(revision);
+    optional_string(language);
+    optional_string(url);
+    optional_string(version);
+    number(options);
+    number(tabstop);
+
+    number(processing_instruction ? 1 : 0);
+    if (processing_instruction) {
+        string(processing_instruction->first);
+        string(processing_instruction->second);
+    }
+
+    number(attributes.size() / 2);
+    for (const auto& s : attributes)
+        string(s);
+
+    number(namespaces.size());
+    this->namespaces(namespaces);
+
+    number(macros.size() / 2);
+    for (const auto& s : macros)
+        string(s);
+
+    write_record();
+}
+
+/**
+ * write_unit
+ * @param unit a unit with its body read or parsed
+ *
+ * Write a unit record.
+ */
+void srcml_binary_writer::write_unit(const srcml_unit* unit) {
+
+    record.clear();
+
+    optional_string(unit->encoding);
+    optional_string(unit->revision);
+    optional_string(unit->language);
+    optional_string(unit->filename);
+    optional_string(unit->url);
+    optional_string(unit->version);
+    optional_string(unit->timestamp);
+    optional_string(unit->hash);
+
+    number(unit->attributes.size() / 2);
+    for (size_t pos = 0; pos + 1 < unit->attributes.size(); pos += 2) {
+        interned(unit->attributes[pos]);
+        string(unit->attributes[pos + 1]);
+    }
+
+    number(unit->namespaces ? unit->namespaces->size() + 1 : 0);
+    if (unit->namespaces)
+        namespaces(*unit->namespaces);
+
+    number(unit->derived_language);
+    number(unit->loc + 1);
+
+    number(unit->content_begin);
+    number(unit->content_end);
+    number(unit->insert_begin);
+    number(unit->insert_end);
+
+    string(unit->srcml);
+
+    xmlOutputBufferWrite(output, 1, (const char*) &BINARY_UNIT);
+    write_record();
+}
+
+/**
+ * write_end
+ *
+ * Write the end record.
+ */
+void srcml_binary_writer::write_end() {
+
+    xmlOutputBufferWrite(output, 1, (const char*) &BINARY_END);
+}
+
+/**
+ * write_record
+ *
+ * Write the size of the formed record, then the record.
+ */
+void srcml_binary_writer::write_record() {
+
+    std::string fields;
+    fields.swap(record);
+
+    number(fields.size());
+    xmlOutputBufferWrite(output, (int) record.size(), record.c_str());
+    xmlOutputBufferWrite(output, (int) fields.size(), fields.c_str());
+
+    record.swap(fields);
+}
+
+/**
+ * number
+ * @param value a number to append to the record
+ *
+ * Append a number as a varint.
+ */
+void srcml_binary_writer::number(unsigned long long value) {
+
+    while (value >= 0x80) {
+        record += (char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    record += (char) value;
+}
+
+/**
+ * string
+ * @param s a string to append to the record
+ */
+void srcml_binary_writer::string(const std::string& s) {
+
+    number(s.size());
+    record.append(s);
+}
+
+/**
+ * optional_string
+ * @param s a string to append to the record, or 0 for none
+ */
+void srcml_binary_writer::optional_string(const char* s) {
+
+    if (!s) {
+        number(0);
+        return;
+    }
+
+    size_t size = strlen(s);
+    number(size + 1);
+    record.append(s, size);
+}
+
+/**
+ * optional_string
+ * @param s a string to append to the record, if any
+ */
+void srcml_binary_writer::optional_string(const boost::optional<std::string>& s) {
+
+    if (!s) {
+        number(0);
+        return;
+    }
+
+    number(s->size() + 1);
+    record.append(*s);
+}
+
+/**
+ * interned
+ * @param name an attribute name to append to the record
+ *
+ * Append the index of a name, with the name itself the first time.
+ */
+void srcml_binary_writer::interned(const std::string& name) {
+
+    auto it = names.find(name);
+    if (it != names.end()) {
+        number(it->second);
+        return;
+    }
+
+    number(names.size());
+    string(name);
+    names.emplace(name, names.size());
+}
+
+/**
+ * namespaces
+ * @param list namespaces to append to the record
+ */
+void srcml_binary_writer::namespaces(const Namespaces& list) {
+
+    for (const auto& ns : list) {
+        string(ns.prefix);
+        string(ns.uri);
+        number((unsigned int) ns.flags);
+    }
+}
+
+/**
+ * is_binary
+ * @param input an input buffer that nothing was read from
+ *
+ * Check for the magic of binary srcML. The input is not consumed. The magic
+ * is checked on the bytes as read, and for binary srcML any conversion from
+ * the encoding of the input is dropped.
+ *
+ * @returns if the input is binary srcML
+ */
+bool srcml_binary_reader::is_binary(xmlParserInputBufferPtr input) {
+
+    if (!input)
+        return false;
+
+    // read without the conversion, unless the input was already converted
+    xmlCharEncodingHandlerPtr encoder = input->encoder;
+    if (encoder) {
+        if (xmlBufUse(input->buffer) != 0 || !input->raw || xmlBufUse(input->raw) != 0)
+            return false;
+
+        input->encoder = nullptr;
+    }
+
+    while (xmlBufUse(input->buffer) < BINARY_MAGIC_SIZE) {
+        if (xmlParserInputBufferGrow(input, BINARY_CHUNK_SIZE) <= 0)
+            break;
+    }
+
+    bool binary = is_binary((const char*) xmlBufContent(input->buffer), xmlBufUse(input->buffer));
+
+    if (encoder) {
+        if (binary) {
+            xmlCharEncCloseFunc(encoder);
+        } else {
+
+            // the bytes read are converted with the rest of the input
+            input->encoder = encoder;
+            std::swap(input->raw, input->buffer);
+        }
+    }
+
+    return binary;
+}
+
+/**
+ * is_binary
+ * @param buffer the start of the input
+ * @param size the size of the buffer
+ *
+ * @returns if the buffer starts with the magic of binary srcML
+ */
+bool srcml_binary_reader::is_binary(const char* buffer, size_t size) {
+
+    return buffer && size >= BINARY_MAGIC_SIZE && memcmp(buffer, BINARY_MAGIC, BINARY_MAGIC_SIZE) == 0;
+}
+
+/**
+ * srcml_binary_reader
+ * @param archive the archive to read the header into
+ * @param input binary srcML input
+ *
+ * Constructor. Reads the header record into the archive.
+ */
+srcml_binary_reader::srcml_binary_reader(srcml_archive* archive, std::unique_ptr<xmlParserInputBuffer> input)
+    : archive(archive), input(std::move(input)) {
+
+    if (!fill(BINARY_MAGIC_SIZE) || memcmp(xmlBufContent(this->input->buffer), BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0)
+        throw std::runtime_error("not binary srcML");
+    xmlBufShrink(this->input->buffer, BINARY_MAGIC_SIZE);
+
+    if (!read_record())
+        throw std::runtime_error("invalid binary srcML header");
+
+    auto xml_encoding = optional_string();
+    archive->revision = optional_string();
+    archive->language = optional_string();
+    archive->url = optional_string();
+    archive->version = optional_string();
+    if (xml_encoding)
+        archive->encoding = xml_encoding;
+
+    // the archive is not written as binary because it was read as binary
+    archive->options = (OPTION_TYPE) number() & ~(OPTION_TYPE) (SRCML_OPTION_BINARY | SRCML_OPTION_INDEX);
+    archive->tabstop = (size_t) number();
+
+    if (number()) {
+        std::string target = string();
+        std::string data = string();
+        archive->processing_instruction = std::make_pair(target, data);
+    }
+
+    archive->attributes.write().clear();
+    for (auto count = number(); count && current; --count) {
+        archive->attributes.write().push_back(string());
+        archive->attributes.write().push_back(string());
+    }
+
+    archive->namespaces = namespaces((size_t) number());
+
+    archive->user_macro_list.write().clear();
+    for (auto count = number(); count && current; --count) {
+        archive->user_macro_list.write().push_back(string());
+        archive->user_macro_list.write().push_back(string());
+    }
+
+    if (!current)
+        throw std::runtime_error("invalid binary srcML header");
+
+    xmlBufShrink(this->input->buffer, record_size);
+}
+
+/**
+ * read_unit
+ * @param unit a new unit to read into
+ *
+ * Read the next unit record. The unit is read completely, including its body.
+ * A truncated or invalid record is an error of the archive.
+ *
+ * @returns if a unit was read
+ */
+bool srcml_binary_reader::read_unit(srcml_unit* unit) {
+
+    if (done)
+        return false;
+
+    // record type
+    if (!fill(1))
+        return invalid("Incomplete binary srcML, missing the end record");
+
+    unsigned char type = *xmlBufContent(input->buffer);
+    xmlBufShrink(input->buffer, 1);
+
+    if (type == BINARY_END) {
+        done = true;
+        return false;
+    }
+
+    if (type != BINARY_UNIT)
+        return invalid("Invalid binary srcML record");
+
+    if (!read_record())
+        return invalid("Incomplete binary srcML unit record");
+
+    unit->encoding = optional_string();
+    unit->revision = optional_string();
+    unit->language = optional_string();
+    unit->filename = optional_string();
+    unit->url = optional_string();
+    unit->version = optional_string();
+    unit->timestamp = optional_string();
+    unit->hash = optional_string();
+
+    for (auto count = number(); count && current; --count) {
+        unit->attributes.push_back(interned());
+        unit->attributes.push_back(string());
+    }
+
+    auto namespace_count = number();
+    if (namespace_count)
+        unit->namespaces = namespaces((size_t) namespace_count - 1);
+
+    unit->derived_language = (int) number();
+    unit->loc = (int) number() - 1;
+
+    unit->content_begin = (int) number();
+    unit->content_end = (int) number();
+    unit->insert_begin = (int) number();
+    unit->insert_end = (int) number();
+
+    unit->srcml = string();
+
+    xmlBufShrink(input->buffer, record_size);
+
+    // the offsets are into the srcML
+    auto offset = [&unit](int pos) { return pos >= 0 && (size_t) pos <= unit->srcml.size(); };
+    if (!current || !offset(unit->content_begin) || !offset(unit->content_end) ||
+        !offset(unit->insert_begin) || !offset(unit->insert_end))
+        return invalid("Invalid binary srcML unit record");
+
+    unit->read_header = true;
+    unit->read_body = true;
+
+    return true;
+}
+
+/**
+ * invalid
+ * @param message description of the error
+ *
+ * Record an error in the input as the error of the archive, and end the input.
+ *
+ * @returns false
+ */
+bool srcml_binary_reader::invalid(const char* message) {
+
+    done = true;
+    archive->error_number = SRCML_STATUS_INVALID_INPUT;
+    archive->error_string = message;
+
+    return false;
+}
+
+/**
+ * fill
+ * @param size number of bytes needed
+ *
+ * Grow the input until it has size bytes.
+ *
+ * @returns if the input has size bytes
+ */
+bool srcml_binary_reader::fill(size_t size) {
+
+    while (xmlBufUse(input->buffer) < size) {
+        if (xmlParserInputBufferGrow(input.get(), (int) std::max(size - xmlBufUse(input->buffer), (size_t) BINARY_CHUNK_SIZE)) <= 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * read_number
+ * @param value the number read
+ *
+ * Read and consume a varint from the input.
+ *
+ * @returns if a number was read
+ */
+bool srcml_binary_reader::read_number(unsigned long long& value) {
+
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+
+        if (!fill(1))
+            return false;
+
+        unsigned char c = *xmlBufContent(input->buffer);
+        xmlBufShrink(input->buffer, 1);
+
+        value |= (unsigned long long) (c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * read_record
+ *
+ * Read the size of a record, and then the entire record into the input.
+ * The record is consumed after its fields are read.
+ *
+ * @returns if the record was read
+ */
+bool srcml_binary_reader::read_record() {
+
+    unsigned long long size = 0;
+    if (!read_number(size) || !fill((size_t) size)) {
+        current = end = nullptr;
+        return false;
+    }
+
+    record_size = (size_t) size;
+    current = xmlBufContent(input->buffer);
+    end = current + record_size;
+
+    return true;
+}
+
+/**
+ * number
+ *
+ * Read a varint from the record. Past the end of the record,
+ * the record is invalid.
+ *
+ * @returns the number, or 0 when invalid
+ */
+unsigned long long srcml_binary_reader::number() {
+
+    unsigned long long value = 0;
+    for (int shift = 0; current && current < end && shift < 64; shift += 7) {
+
+        unsigned char c = *current++;
+        value |= (unsigned long long) (c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return value;
+    }
+
+    current = nullptr;
+    return 0;
+}
+
+/**
+ * string
+ *
+ * @returns a string read from the record
+ */
+std::string srcml_binary_reader::string() {
+
+    auto size = number();
+    if (!current || size > (unsigned long long) (end - current)) {
+        current = nullptr;
+        return std::string();
+    }
+
+    std::string s((const char*) current, (size_t) size);
+    current += size;
+
+    return s;
+}
+
+/**
+ * optional_string
+ *
+ * @returns an optional string read from the record
+ */
+boost::optional<std::string> srcml_binary_reader::optional_string() {
+
+    auto size = number();
+    if (!current || size == 0)
+        return boost::none;
+
+    if (size - 1 > (unsigned long long) (end - current)) {
+        current = nullptr;
+        return boost::none;
+    }
+
+    std::string s((const char*) current, (size_t) size - 1);
+    current += size - 1;
+
+    return s;
+}
+
+/**
+ * interned
+ *
+ * @returns an interned name read from the record
+ */
+const std::string& srcml_binary_reader::interned() {
+
+    static const std::string empty;
+
+    auto index = number();
+    if (index < names.size())
+        return names[(size_t) index];
+
+    if (index > names.size()) {
+        current = nullptr;
+        return empty;
+    }
+
+    names.push_back(string());
+
+    return names.back();
+}
+
+/**
+ * namespaces
+ * @param count the number of namespaces
+ *
+ * @returns the namespaces read from the record
+ */
+Namespaces srcml_binary_reader::namespaces(size_t count) {
+
+    Namespaces list;
+    for (; count && current; --count) {
+
+        Namespace ns;
+        ns.prefix = string();
+        ns.uri = string();
+        ns.flags = (int) number();
+        list.push_back(ns);
+    }
+
+    return list;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file srcml_binary.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+  Binary srcML, a compact encoding of a srcML archive for pipelines of srcml
+  invocations. The units are stored as they are held in a srcml_unit, so they
+  are read without parsing XML, and are written as XML exactly as the units
+  they were written from. Binary srcML is written and read as bytes, without
+  conversion to or from the XML encoding of the archive.
+
+  The format is:
+
+    magic           the 8 bytes "\0srcMLb1". XML never starts with a null byte.
+    header record   size, then the fields of the archive
+    unit records    UNIT, size, then the fields of the unit
+    end record      END
+
+  A number is an unsigned LEB128 varint. A string is its length, then its bytes.
+  An optional string is 0 when absent, otherwise its length + 1, then its bytes.
+  A list is its count, then its items.
+
+  Header fields:
+    xml encoding, revision, language, url, version (optional strings)
+    options, tabstop (numbers)
+    processing instruction (0 when absent, otherwise 1, then target and data strings)
+    attributes (list of name and value strings)
+    namespaces (list of prefix and uri strings, and flags)
+    macros (list of token and type strings)
+
+  Unit fields:
+    encoding, revision, language, filename, url, version, timestamp, hash (optional strings)
+    attributes (list of interned name and value string)
+    namespaces (0 when absent, otherwise count + 1, then as in the header)
+    derived language, loc + 1 (numbers)
+    content begin, content end, insert begin, insert end (offsets into the srcML)
+    srcML (string)
+
+  An interned name is the index of a name already in the stream, or the number
+  of names so far followed by the new name as a string.
+*/
+
+#ifndef INCLUDED_SRCML_BINARY_HPP
+#define INCLUDED_SRCML_BINARY_HPP
+
+#include <srcml_types.hpp>
+
+#include <libxml/xmlIO.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * srcml_binary_writer
+ *
+ * Writes binary srcML to a libxml2 output buffer.
+ */
+class srcml_binary_writer {
+public:
+
+    srcml_binary_writer(xmlOutputBufferPtr output) : output(output) {}
+
+    // write the magic and the header record
+    void write_header(const char* xml_encoding, const char* revision, const char* language, const char* url, const char* version,
+                      OPTION_TYPE options, size_t tabstop,
+                      const boost::optional<std::pair<std::string, std::string>>& processing_instruction,
+                      const std::vector<std::string>& attributes, const Namespaces& namespaces,
+                      const std::vector<std::string>& macros);
+
+    // write a unit record
+    void write_unit(const srcml_unit* unit);
+
+    // write the end record
+    void write_end();
+
+private:
+    void write_record();
+    void number(unsigned long long value);
+    void string(const std::string& s);
+    void optional_string(const char* s);
+    void optional_string(const boost::optional<std::string>& s);
+    void interned(const std::string& name);
+    void namespaces(const Namespaces& list);
+
+    xmlOutputBufferPtr output;
+
+    /** the record being formed, reused between records */
+    std::string record;
+
+    /** attribute names by their index */
+    std::unordered_map<std::string, size_t> names;
+};
+
+/**
+ * srcml_binary_reader
+ *
+ * Reads binary srcML from a libxml2 input buffer.
+ */
+class srcml_binary_reader {
+public:
+
+    // read the header into the archive, throws on an invalid header
+    srcml_binary_reader(srcml_archive* archive, std::unique_ptr<xmlParserInputBuffer> input);
+
+    // read the next unit, if any, with an invalid record reported as an error of the archive
+    bool read_unit(srcml_unit* unit);
+
+    // whether the input starts with the magic of binary srcML, before any conversion of the input
+    static bool is_binary(xmlParserInputBufferPtr input);
+
+    // whether the memory starts with the magic of binary srcML
+    static bool is_binary(const char* buffer, size_t size);
+
+private:
+    bool fill(size_t size);
+    bool read_number(unsigned long long& value);
+    bool read_record();
+    bool invalid(const char* message);
+
+    srcml_archive* archive;
+
+    std::unique_ptr<xmlParserInputBuffer> input;
+
+    /** the record being read */
+    const unsigned char* current = nullptr;
+    const unsigned char* end = nullptr;
+    size_t record_size = 0;
+
+    unsigned long long number();
+    std::string string();
+    boost::optional<std::string> optional_string();
+    const std::string& interned();
+    Namespaces namespaces(size_t count);
+
+    /** attribute names by their index */
+    std::vector<std::string> names;
+
+    /** the input ended */
+    bool done = false;
+};
+
+#endif
@@ -37,11 +37,11 @@
 #include <string>
 #include <vector>
 #include <stack>
+#include <deque>
+#include <memory>
 
 #include <cstring>
 
-#include <mutex>
-#include <condition_variable>
 #include <boost/optional.hpp>
 
 #define ATTR_LOCALNAME(pos) (pos * 5)
@@ -74,43 +74,30 @@ struct attribute_t {
  * srcml_reader_handler
  *
  * Inherits from srcMLHandler to provide hooks into
- * SAX2 parsing. Provides starting and stoping using
- * threads.  Collects attributes, namespaces and srcML
- * from units.
+ * SAX2 parsing. Collects attributes, namespaces and srcML
+ * from units.  Completed units are queued until requested,
+ * since a chunk of input may contain more than one unit.
  */
 class srcml_reader_handler : public srcSAXHandler {
 
 private :
 
-    /** mutex to halt both threads on */
-    std::mutex mutex;
-
-    /** sax stop/start condition */
-    std::condition_variable cond;
-
     /** collected root language */
     srcml_archive* archive = nullptr;
 
-    /** collected unit language */
-    srcml_unit* unit = nullptr;
+    /** unit currently being collected */
+    std::unique_ptr<srcml_unit> unit;
+
+    /** completed units not yet requested */
+    std::deque<std::unique_ptr<srcml_unit>> units;
+
+    /** collect the body of units, or only their header */
+    bool collect_body = true;
 
     /** has reached end of parsing*/
     bool is_done = false;
     /** has passed root*/
     bool read_root = false;
-    /** stop after collecting unit attribute*/
-    bool collect_unit_header = false;
-    /** collect srcML as parse*/
-    bool collect_unit_body = false;
-
-    /** terminate */
-    bool terminate = false;
-
-    /** indicate if we need to wait on the root */
-    bool wait_root = true;
-
-    /** skip internal unit elements */
-    bool skip = false;
 
 public :
 
@@ -120,7 +107,7 @@ public :
     /**
      * srcml_reader_handler
      *
-     * Constructor.  Sets up mutex, conditions and state.
+     * Constructor.
      */
     srcml_reader_handler() {
     }
@@ -128,64 +115,9 @@ public :
     /**
      * ~srcml_reader_handler
      *
-     * Destructor, deletes mutex and conditions.
+     * Destructor.
      */
     ~srcml_reader_handler() {
-     }
-
-    /**
-     * stop_parser
-     *
-     * Stop the parser for threading
-     */
-    void stop_parser() {
-
-        is_done = true;
-        srcSAXHandler::stop_parser();
-    }
-
-    /**
-     * wait
-     *
-     * Allows calling thread to wait until reached
-     * end of unit.
-     */
-    void wait() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-
-        if (is_done)
-            return;
-
-        if (wait_root)
-            cond.wait(lock);
-    }
-
-    /**
-     * resume
-     *
-     * Resume SAX2 execution.
-     */
-    void resume() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-
-        cond.notify_one();
-    }
-
-    /**
-     * resume_and_wait
-     *
-     * Atomic resume SAX2 execution then wait.
-     */
-    void resume_and_wait() {
-
-        std::unique_lock<std::mutex> lock(mutex);
-        cond.notify_one();
-        if (is_done)
-            return;
-
-        cond.wait(lock);
     }
 
     /**
@@ -196,25 +128,6 @@ public :
     void done() {
 
         is_done = true;
-
-        cond.notify_one();
-    }
-
-    /**
-     * stop
-     *
-     * Stops SAX2 parsing Completely.  Parsing
-     * Can not be restarted.
-     */
-    void stop() {
-
-        {
-            std::unique_lock<std::mutex> lock(mutex);
-
-            terminate = true;
-        }
-
-        resume();
     }
 
 #pragma GCC diagnostic push
@@ -303,8 +216,8 @@ public :
                 ;
             else {
 
-                archive->attributes.push_back(attribute);
-                archive->attributes.push_back(value);
+                archive->attributes.write().push_back(attribute);
+                archive->attributes.write().push_back(value);
             }
         }
 
@@ -319,6 +232,8 @@ public :
             srcml_archive_register_namespace(archive, prefix.c_str(), uri.c_str());
         }
 
+        read_root = true;
+
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
@@ -345,52 +260,16 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
-        // pause
-        if (!read_root) {
-
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-
-                if (terminate)
-                    stop_parser();
-                wait_root = false;
-                cond.notify_one();
-                cond.wait(lock);
-                read_root = true;
-            }
-
-            if (terminate) {
-
-                stop_parser();
-                return;
-            }
-        }
-
         // collect attributes
-        unit_update_attributes(unit, num_attributes, attributes);
+        unit.reset(srcml_unit_create(archive));
+        unit_update_attributes(unit.get(), num_attributes, attributes);
 
         auto ctxt = (xmlParserCtxtPtr) get_controller().getContext()->libxml2_context;
         auto state = (sax2_srcsax_handler*) ctxt->_private;
 
-        state->collect_unit_body = collect_unit_body;
-
-        if (collect_unit_header) {
-
-            // pause
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate)
-                stop_parser();
-
-            cond.notify_one();
-            cond.wait(lock);
-        }
-
         state->loc = 0;
 
-        state->collect_unit_body = collect_unit_body;
-
-        if (terminate)
-            stop_parser();
+        state->collect_unit_body = collect_body;
 
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -412,16 +291,7 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
-        {
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate)
-                stop_parser();
-            is_done = true;
-            cond.notify_one();
-        }
-
-        if (terminate)
-            stop_parser();
+        is_done = true;
 
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -442,49 +312,51 @@ public :
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
 #endif
 
+        // end of a unit whose start was not reported, e.g., a solo unit before the root is known
+        if (!unit)
+            return;
+
         auto ctxt = (xmlParserCtxtPtr) get_controller().getContext()->libxml2_context;
         auto state = (sax2_srcsax_handler*) ctxt->_private;
 
-        if (collect_unit_body) {
-
-            if (!state->unitsrc.empty() && state->unitsrc.back() != '\n')
-                ++state->loc;
+        if (state->collect_unit_body ? !state->unitsrc.empty() && state->unitsrc.back() != '\n' : state->partial_line)
+            ++state->loc;
 
-            unit->content_begin = state->content_begin;
-            unit->content_end = state->content_end;
-            unit->insert_begin = state->insert_begin;
-            unit->insert_end = state->insert_end;
-            unit->srcml = std::move(state->unitsrcml);
-            unit->src = std::move(state->unitsrc);
-            unit->loc = state->loc;
+        unit->content_begin = state->content_begin;
+        unit->content_end = state->content_end;
+        unit->insert_begin = state->insert_begin;
+        unit->insert_end = state->insert_end;
+        unit->srcml = std::move(state->unitsrcml);
+        unit->src = std::move(state->unitsrc);
+        unit->loc = state->loc;
 
-            // update provisional cpp prefix
-            if (state->cpp_prefix) {
-
-                // namespaces probably aren't create yet
-                if (!unit->namespaces) {
-                    unit->namespaces = default_namespaces;
-                }
+        // update provisional cpp prefix
+        if (state->cpp_prefix) {
 
-                // set the found prefix, plus mark it as used
-                auto&& view = unit->namespaces->get<nstags::uri>();
-                auto it = view.find(SRCML_CPP_NS_URI);
-                if (it != view.end()) {
-                    view.modify(it, [](Namespace& thisns){ thisns.flags |= NS_USED; });
-                } else {
-                    unit->namespaces->push_back({ state->cpp_prefix->c_str(), SRCML_CPP_NS_URI, NS_USED | NS_STANDARD });
-                }
+            // namespaces probably aren't create yet
+            if (!unit->namespaces) {
+                unit->namespaces = default_namespaces;
             }
 
-            // pause
-            std::unique_lock<std::mutex> lock(mutex);
-            if (terminate) stop_parser();
-            cond.notify_one();
-            cond.wait(lock);
+            // set the found prefix, plus mark it as used
+            auto&& view = unit->namespaces->get<nstags::uri>();
+            auto it = view.find(SRCML_CPP_NS_URI);
+            if (it != view.end()) {
+                view.modify(it, [](Namespace& thisns){ thisns.flags |= NS_USED; });
+            } else {
+                unit->namespaces->push_back({ state->cpp_prefix->c_str(), SRCML_CPP_NS_URI, NS_USED | NS_STANDARD });
+            }
         }
 
-        if (terminate)
-            stop_parser();
+        unit->read_header = true;
+        unit->has_body = state->collect_unit_body;
+        unit->read_body = unit->has_body;
+
+        units.push_back(std::move(unit));
+
+        // only the requested unit is header only, the units parsed ahead of a read are complete
+        if (!state->collect_unit_body)
+            collect_body = true;
 
 #ifdef SRCSAX_DEBUG
         fprintf(stderr, "HERE: %s %s %d '%s'\n", __FILE__, __FUNCTION__, __LINE__, (const char *)localname);
@@ -523,8 +395,8 @@ public :
 
             if (token != "" && type != "") {
 
-                archive->user_macro_list.push_back(token);
-                archive->user_macro_list.push_back(type);
+                archive->user_macro_list.write().push_back(token);
+                archive->user_macro_list.write().push_back(type);
             }
 
         }
@@ -26,35 +26,6 @@
 #include <stdlib.h>
 #include <cstring>
 
-#include <iostream>
-
-/**
- * start_routine
- * @param arguments thread_args structure with control and handler
- *
- * Starts the parsing of the document.
- */
-static void* start_routine(thread_args* args) {
-
-    try {
-
-        args->control->parse(args->handler);
-
-    } catch(SAXError error) {
-
-        if (!(error.error_code == XML_ERR_EXTRA_CONTENT || error.error_code == XML_ERR_DOCUMENT_END)) {
-
-            fprintf(stderr, "Error Parsing: %s\n", error.message.c_str());
-
-            args->handler->done();
-        }
-
-        // might have to release a lock here or set is_done
-    }
-
-    return 0;
-}
-
 /**
  * srcml_sax2_reader
  * @param input parser input buffer
@@ -66,11 +37,9 @@ srcml_sax2_reader::srcml_sax2_reader(srcml_archive* archive, std::unique_ptr<xml
 
     handler.archive = archive;
 
-    // Setup thread here after things are created and settled
-    // Do not put in member initialization list as it can cause random crashes
-    thread = std::thread(start_routine, &args);
-
-    handler.wait();
+    // parse far enough to collect the root attributes
+    while (!handler.read_root && parse_chunk())
+        ;
 }
 
 /**
@@ -79,111 +48,108 @@ srcml_sax2_reader::srcml_sax2_reader(srcml_archive* archive, std::unique_ptr<xml
  * Destructor a srcml_sax2_reader
  */
 srcml_sax2_reader::~srcml_sax2_reader() {
+}
 
-    handler.stop();
+/**
+ * parse_chunk
+ *
+ * Parse the next chunk of input on the calling thread.
+ * Any completed units are queued in the handler. An error in the
+ * input is the error of the archive, and ends the input.
+ *
+ * @returns true if there is more to parse, false if done.
+ */
+bool srcml_sax2_reader::parse_chunk() {
+
+    if (handler.is_done)
+        return false;
 
-    if (thread.joinable()) {
-        try {
-            thread.join();
-        } catch(const std::system_error& e) {
-            std::cerr << "srcml: Internal error " << e.code() << " meaning " << e.what() << '\n';
+    try {
+
+        if (!control.parse_chunk(&handler))
+            handler.done();
+
+    } catch(SAXError error) {
+
+        // content after the end of the root is not an error
+        if (!handler.is_done) {
+
+            handler.archive->error_number = SRCML_STATUS_INVALID_INPUT;
+            handler.archive->error_string = error.message.substr(0, error.message.find_last_not_of('\n') + 1);
         }
+
+        handler.done();
     }
+
+    return !handler.is_done;
 }
 
 /**
  * read_header
- * @param language a location to store the language attribute
- * @param filename a location to store the filename attribute
- * @param url a location to store the url attribute
- * @param version a location to store the version attribute
+ * @param unit the unit to read into
+ * @param collect_body whether to collect the body of the unit
  *
- * Read attributes from next unit.
+ * Read attributes from next unit. Without collecting the body, the next unit
+ * parsed only has its header. Units parsed ahead of it are still complete.
  *
  * @returns 1 on success and 0 on failure.
  */
-int srcml_sax2_reader::read_header(srcml_unit* unit) {
-
-    handler.unit = unit;
+int srcml_sax2_reader::read_header(srcml_unit* unit, bool collect_body) {
 
-    if (handler.is_done)
-        return 0;
+    // the next unit to start is the one for this read
+    if (handler.units.empty() && !handler.unit)
+        handler.collect_body = collect_body;
 
-    handler.skip = true;
-    handler.collect_unit_header = true;
-    handler.collect_unit_body = false;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
-    handler.collect_unit_header = false;
-    handler.skip = false;
+    while (handler.units.empty() && parse_chunk())
+        ;
 
-    if (handler.is_done)
+    if (handler.units.empty())
         return 0;
 
-    handler.unit = 0;
+    // the body is already collected, but is not available until read_body()
+    *unit = std::move(*handler.units.front());
+    handler.units.pop_front();
 
     unit->read_header = true;
+    unit->read_body = false;
 
     return 1;
 }
 
 /**
  * read
- * @param language a location to store the language attribute
- * @param filename a location to store the filename attribute
- * @param url a location to store the url attribute
- * @param version a location to store the version attribute
+ * @param unit the unit to read into
  *
- * Read attributes from next unit.
+ * Read attributes and srcML from next unit.
  *
  * @returns 1 on success and 0 on failure.
  */
 int srcml_sax2_reader::read(srcml_unit* unit) {
 
-    handler.unit = unit;
-
-    if (handler.is_done)
-        return 0;
-
-    handler.skip = true;
-    handler.collect_unit_header = true;
-    handler.collect_unit_body = true;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
-    handler.collect_unit_header = false;
-    handler.skip = false;
-
-    if (handler.is_done)
+    if (!read_header(unit))
         return 0;
 
-    handler.unit = 0;
-
-    unit->read_header = true;
-    unit->read_body = true;
+    unit->read_body = unit->has_body;
 
     return 1;
 }
 
 /**
  * read_body
- * @param output_buffer output buffer to write text
+ * @param unit the unit to read into
  *
- * Read the next unit from a srcML Archive
- * and return in the passed string parameter.
+ * Read the srcML of the unit from a srcML Archive.
+ * If the header of the unit was not read, reads the next unit.
  *
  * @returns 1 on success and 0 if done
  */
 int srcml_sax2_reader::read_body(srcml_unit* unit) {
 
-    if (handler.is_done)
-        return 0;
-
-    handler.unit = unit;
-    handler.collect_unit_body = true;
-    handler.resume_and_wait();
-    handler.collect_unit_body = false;
+    if (!unit->read_header)
+        return read(unit);
 
-    if (handler.is_done)
+    // body was not collected when the unit was parsed
+    if (!unit->has_body)
         return 0;
 
     unit->read_body = true;
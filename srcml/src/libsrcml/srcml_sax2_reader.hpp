@@ -34,30 +34,15 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 #include <boost/optional.hpp>
 
-/**
- * thread_args
- *
- * Structure to hold information to pass
- * to thread function.
- */
-struct thread_args {
-
-    /** control for sax processing */
-    srcSAXController* control;
-
-    /** handler with hooks for sax processing */
-    srcml_reader_handler* handler;
-};
-
 /**
  * srcml_sax2_reader
  *
  * Extend XML Text Reader interface to
  * progressively read a srcML Archive collecting
- * units and reading unit attributes.
+ * units and reading unit attributes.  Parsing is
+ * performed on the calling thread as units are requested.
  */
 class srcml_sax2_reader {
 
@@ -71,9 +56,8 @@ public :
 
 private :
 
-    /** thread running execution */
-    std::thread thread;
-    thread_args args = { &control, &handler };
+    // parse the next chunk of input
+    bool parse_chunk();
 
 public :
 
@@ -86,7 +70,7 @@ public :
     /* finds next unit tag if not current unit and sets attributes.  Consumes unit.
        Unit is still avaible for readsrcML or read.  But not readUnitAttributes.
     */
-    int read_header(srcml_unit* unit);
+    int read_header(srcml_unit* unit, bool collect_body = true);
 
     int read(srcml_unit* unit);
 
@@ -0,0 +1,176 @@
+/**
+ * @file srcml_statistics.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <srcml_statistics.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+thread_local srcml_unit_statistics* srcml_thread_statistics = nullptr;
+
+thread_local srcml_statistics_nested_timer* srcml_statistics_nested_timer::current = nullptr;
+
+namespace {
+
+    const char* const STAGE_NAMES[SRCML_STAGE_COUNT] = {
+        "input", "lex", "guess", "rewind", "parse", "finalize", "output", "extract", "transform"
+    };
+
+    const char* const AMOUNT_NAMES[SRCML_STAGE_COUNT] = {
+        "bytes", "tokens", "", "", "bytes", "", "bytes", "bytes", ""
+    };
+
+    // stages that are only counted, as they are too frequent or too short to time
+    bool is_counted_only(int stage) {
+
+        return stage == SRCML_STAGE_LEX || stage == SRCML_STAGE_REWIND;
+    }
+}
+
+void srcml_stage_statistics::add(unsigned long long event_amount, unsigned long long event_nanoseconds) {
+
+    add(event_amount);
+
+    nanoseconds += event_nanoseconds;
+    max_nanoseconds = std::max(max_nanoseconds, event_nanoseconds);
+
+    // bucket 0 is under 1 us, bucket n is under 2^n us
+    int bucket = 0;
+    for (unsigned long long us = event_nanoseconds / 1000; us && bucket < HISTOGRAM_SIZE - 1; us >>= 1)
+        ++bucket;
+
+    ++histogram[bucket];
+}
+
+void srcml_stage_statistics::merge(const srcml_stage_statistics& other) {
+
+    count += other.count;
+    amount += other.amount;
+    nanoseconds += other.nanoseconds;
+    max_nanoseconds = std::max(max_nanoseconds, other.max_nanoseconds);
+    for (int i = 0; i < HISTOGRAM_SIZE; ++i)
+        histogram[i] += other.histogram[i];
+}
+
+/**
+ * add
+ * @param stage the stage of the event
+ * @param amount the amount of the event, e.g., bytes
+ * @param nanoseconds the time of the event
+ *
+ * Add a single event of a stage.
+ */
+void srcml_statistics::add(srcml_statistics_stage stage, unsigned long long amount, unsigned long long nanoseconds) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    totals.stages[stage].add(amount, nanoseconds);
+}
+
+/**
+ * add_unit
+ * @param unit the statistics of the unit
+ * @param filename the filename of the unit
+ *
+ * Add the statistics of a parsed unit, and record it if it is one of the slowest.
+ */
+void srcml_statistics::add_unit(const srcml_unit_statistics& unit, const std::string& filename) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (int stage = 0; stage < SRCML_STAGE_COUNT; ++stage)
+        totals.stages[stage].merge(unit.stages[stage]);
+
+    unsigned long long nanoseconds = unit.stages[SRCML_STAGE_PARSE].nanoseconds;
+    if (slowest.size() < SLOWEST_UNITS || nanoseconds > slowest.back().first) {
+
+        auto pos = std::find_if(slowest.begin(), slowest.end(), [nanoseconds](const std::pair<unsigned long long, std::string>& entry) {
+            return nanoseconds > entry.first;
+        });
+        slowest.insert(pos, std::make_pair(nanoseconds, filename));
+
+        if (slowest.size() > SLOWEST_UNITS)
+            slowest.pop_back();
+    }
+}
+
+/**
+ * report
+ *
+ * Form a human-readable report of the statistics of each stage,
+ * the histograms of their times, and the slowest units.
+ *
+ * @returns the report
+ */
+std::string srcml_statistics::report() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::ostringstream out;
+    out << std::left << std::setw(12) << "stage" << std::right << std::setw(12) << "count"
+        << std::setw(16) << "amount" << std::setw(14) << "total ms" << std::setw(12) << "mean us" << std::setw(12) << "max us" << '\n';
+
+    for (int stage = 0; stage < SRCML_STAGE_COUNT; ++stage) {
+
+        const auto& stats = totals.stages[stage];
+        out << std::left << std::setw(12) << STAGE_NAMES[stage] << std::right << std::setw(12) << stats.count;
+        if (*AMOUNT_NAMES[stage])
+            out << std::setw(16) << (std::to_string(stats.amount) + " " + AMOUNT_NAMES[stage]);
+        else
+            out << std::setw(16) << "";
+
+        // the lexer is only counted, as it runs interleaved with the parser
+        if (!is_counted_only(stage)) {
+            out << std::fixed << std::setprecision(3) << std::setw(14) << stats.nanoseconds / 1e6
+                << std::setw(12) << (stats.count ? stats.nanoseconds / 1e3 / stats.count : 0)
+                << std::setw(12) << stats.max_nanoseconds / 1e3;
+        }
+        out << '\n';
+    }
+
+    out << "\nhistogram (us)\n";
+    for (int stage = 0; stage < SRCML_STAGE_COUNT; ++stage) {
+
+        const auto& stats = totals.stages[stage];
+        if (is_counted_only(stage) || !stats.count)
+            continue;
+
+        out << std::left << std::setw(12) << STAGE_NAMES[stage] << std::right;
+        for (int i = 0; i < srcml_stage_statistics::HISTOGRAM_SIZE; ++i) {
+            if (!stats.histogram[i])
+                continue;
+
+            if (i == srcml_stage_statistics::HISTOGRAM_SIZE - 1)
+                out << " >=" << (1ULL << (i - 1));
+            else
+                out << " <" << (1ULL << i);
+            out << ':' << stats.histogram[i];
+        }
+        out << '\n';
+    }
+
+    if (!slowest.empty()) {
+        out << "\nslowest units (parse ms)\n";
+        for (const auto& entry : slowest)
+            out << std::fixed << std::setprecision(3) << std::setw(12) << entry.first / 1e6 << "  " << entry.second << '\n';
+    }
+
+    return out.str();
+}
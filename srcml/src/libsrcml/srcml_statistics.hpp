@@ -0,0 +1,261 @@
+/**
+ * @file srcml_statistics.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * Counters and latency histograms for the stages of the srcML pipeline.
+ *
+ * The per-token and per-read stages of parsing are collected without locking
+ * into the statistics of the unit being parsed on the current thread, and merged
+ * into the archive when the unit is done. Per-unit stages are added directly
+ * to the archive. Defining NO_SRCML_STATISTICS removes all collection, and is
+ * the default build (CMake option STATISTICS_ENABLED).
+ */
+
+#ifndef INCLUDED_SRCML_STATISTICS_HPP
+#define INCLUDED_SRCML_STATISTICS_HPP
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+
+/** stages of the pipeline with statistics */
+enum srcml_statistics_stage {
+    SRCML_STAGE_INPUT,      // reads of the source input, amount in bytes
+    SRCML_STAGE_LEX,        // tokens from the lexers
+    SRCML_STAGE_GUESS,      // parser guesses with rewinds, i.e., pattern_check(), without nested guesses
+    SRCML_STAGE_REWIND,     // rewinds of the parser to an earlier token
+    SRCML_STAGE_PARSE,      // complete parse of a unit, amount in source bytes
+    SRCML_STAGE_FINALIZE,   // end of a parsed unit, srcml_write_end_unit()
+    SRCML_STAGE_OUTPUT,     // units written to the archive, amount in bytes
+    SRCML_STAGE_EXTRACT,    // source extracted from srcML, amount in srcML bytes
+    SRCML_STAGE_TRANSFORM,  // transformations applied to a unit
+    SRCML_STAGE_COUNT
+};
+
+/**
+ * srcml_stage_statistics
+ *
+ * Count, amount, time, and log2 histogram of the time of the events of a stage.
+ */
+struct srcml_stage_statistics {
+
+    /** histogram buckets, each twice the previous in microseconds, with the last for everything larger */
+    static const int HISTOGRAM_SIZE = 24;
+
+    unsigned long long count = 0;
+    unsigned long long amount = 0;
+    unsigned long long nanoseconds = 0;
+    unsigned long long max_nanoseconds = 0;
+    unsigned long long histogram[HISTOGRAM_SIZE] = {};
+
+    void add(unsigned long long event_amount) {
+
+        ++count;
+        amount += event_amount;
+    }
+
+    void add(unsigned long long event_amount, unsigned long long event_nanoseconds);
+
+    void merge(const srcml_stage_statistics& other);
+};
+
+/**
+ * srcml_unit_statistics
+ *
+ * Statistics of the stages for a single unit.
+ */
+struct srcml_unit_statistics {
+    srcml_stage_statistics stages[SRCML_STAGE_COUNT];
+};
+
+/**
+ * srcml_statistics
+ *
+ * Statistics of an archive, safe for use from multiple threads.
+ */
+class srcml_statistics {
+public:
+
+    /** number of the slowest units to keep */
+    static const size_t SLOWEST_UNITS = 10;
+
+    // add a single event of a stage
+    void add(srcml_statistics_stage stage, unsigned long long amount, unsigned long long nanoseconds);
+
+    // add the statistics of a parsed unit
+    void add_unit(const srcml_unit_statistics& unit, const std::string& filename);
+
+    // human-readable report of all statistics
+    std::string report() const;
+
+private:
+    mutable std::mutex mutex;
+    srcml_unit_statistics totals;
+    std::vector<std::pair<unsigned long long, std::string>> slowest;
+};
+
+/** statistics of the unit being parsed on this thread, if any */
+extern thread_local srcml_unit_statistics* srcml_thread_statistics;
+
+/**
+ * srcml_statistics_timer
+ *
+ * Times the scope it is declared in as an event of a stage. The event goes into
+ * the statistics of the unit being parsed on this thread, if there is one, otherwise
+ * into the given archive statistics.
+ */
+class srcml_statistics_timer {
+public:
+
+    srcml_statistics_timer(srcml_statistics_stage stage, unsigned long long amount = 0)
+        : stage(stage), amount(amount), unit(srcml_thread_statistics) {
+
+        if (unit)
+            start = std::chrono::steady_clock::now();
+    }
+
+    srcml_statistics_timer(srcml_statistics* archive, srcml_statistics_stage stage, unsigned long long amount = 0)
+        : stage(stage), amount(amount), unit(srcml_thread_statistics), archive(unit ? nullptr : archive) {
+
+        if (unit || archive)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~srcml_statistics_timer() {
+
+        if (!unit && !archive)
+            return;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (unit)
+            unit->stages[stage].add(amount, (unsigned long long) elapsed);
+        else
+            archive->add(stage, amount, (unsigned long long) elapsed);
+    }
+
+    /** set the amount when it is only known at the end */
+    void set_amount(unsigned long long new_amount) { amount = new_amount; }
+
+private:
+    srcml_statistics_stage stage;
+    unsigned long long amount;
+    srcml_unit_statistics* unit = nullptr;
+    srcml_statistics* archive = nullptr;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * srcml_statistics_nested_timer
+ *
+ * Times a scope of the unit being parsed on this thread that can be nested in
+ * another, e.g., a parser guess during a guess. The time of an event does not
+ * include its nested events, so the time of the stage does not count them twice.
+ */
+class srcml_statistics_nested_timer {
+public:
+
+    srcml_statistics_nested_timer(srcml_statistics_stage stage)
+        : stage(stage), unit(srcml_thread_statistics), parent(current) {
+
+        if (!unit)
+            return;
+
+        current = this;
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~srcml_statistics_nested_timer() {
+
+        if (!unit)
+            return;
+
+        auto elapsed = (unsigned long long) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        current = parent;
+        if (parent)
+            parent->nested += elapsed;
+
+        unit->stages[stage].add(0, elapsed > nested ? elapsed - nested : 0);
+    }
+
+private:
+    /** innermost timer in progress on this thread */
+    static thread_local srcml_statistics_nested_timer* current;
+
+    srcml_statistics_stage stage;
+    srcml_unit_statistics* unit;
+    srcml_statistics_nested_timer* parent;
+    unsigned long long nested = 0;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * srcml_unit_statistics_scope
+ *
+ * Collects the statistics of parsing a unit on this thread, with the time of the
+ * scope as the parse, and adds them to the archive at the end of the scope.
+ */
+class srcml_unit_statistics_scope {
+public:
+
+    srcml_unit_statistics_scope(srcml_statistics* archive, const char* filename)
+        : archive(archive), filename(filename ? filename : ""), previous(srcml_thread_statistics),
+          start(std::chrono::steady_clock::now()) {
+
+        srcml_thread_statistics = &unit;
+    }
+
+    ~srcml_unit_statistics_scope() {
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        unit.stages[SRCML_STAGE_PARSE].add(unit.stages[SRCML_STAGE_INPUT].amount, (unsigned long long) elapsed);
+
+        srcml_thread_statistics = previous;
+        if (archive)
+            archive->add_unit(unit, filename);
+    }
+
+private:
+    srcml_statistics* archive;
+    std::string filename;
+    srcml_unit_statistics* previous;
+    std::chrono::steady_clock::time_point start;
+    srcml_unit_statistics unit;
+};
+
+#ifndef NO_SRCML_STATISTICS
+
+/** count an event of a stage for the unit being parsed on this thread */
+#define SRCML_STATISTICS_EVENT(stage, amount) \
+    do { if (srcml_thread_statistics) srcml_thread_statistics->stages[stage].add(amount); } while (0)
+
+/** declare an object only when statistics are collected */
+#define SRCML_STATISTICS(declaration) declaration
+
+#else
+
+#define SRCML_STATISTICS_EVENT(stage, amount) do {} while (0)
+#define SRCML_STATISTICS(declaration)
+
+#endif
+
+#endif
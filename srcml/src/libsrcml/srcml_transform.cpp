@@ -83,7 +83,7 @@ static int srcml_append_transform_xpath_internal (struct srcml_archive* archive,
     if (archive == NULL || xpath_string == 0)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
-    archive->transformations.push_back(std::unique_ptr<Transformation>(new xpathTransformation(archive, xpath_string, prefix, namespace_uri, element,
+    archive->transformations.write().push_back(std::unique_ptr<Transformation>(new xpathTransformation(archive, xpath_string, prefix, namespace_uri, element,
             attr_prefix, attr_namespace_uri, attr_name, attr_value)));
 
     return SRCML_STATUS_OK;
@@ -133,8 +133,8 @@ int srcml_append_transform_xpath_attribute(struct srcml_archive* archive, const
         return SRCML_STATUS_INVALID_ARGUMENT;
 
     // attribute for a previous Xpath where the attribute is blank is appended on
-    if (!archive->transformations.empty()) {
-        auto p = dynamic_cast<xpathTransformation*>(archive->transformations.back().get());
+    if (!archive->transformations->empty()) {
+        auto p = dynamic_cast<xpathTransformation*>(archive->transformations->back().get());
         if (p && p->xpath == xpath_string && p->attr_prefix.empty() && p->attr_uri.empty() && p->attr_name.empty() && p->attr_value.empty()) {
 
             p->attr_prefix = prefix;
@@ -191,7 +191,7 @@ static int srcml_append_transform_xslt_internal(srcml_archive* archive, std::uni
     if (archive == NULL || doc == 0)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
-    archive->transformations.push_back(std::unique_ptr<Transformation>(new xsltTransformation(doc.release(), std::vector<std::string>())));
+    archive->transformations.write().push_back(std::unique_ptr<Transformation>(new xsltTransformation(doc.release(), std::vector<std::string>())));
 
     return SRCML_STATUS_OK;
 }
@@ -302,7 +302,7 @@ static int srcml_append_transform_relaxng_internal(srcml_archive* archive, xmlDo
     if (archive == NULL || doc == 0)
         return SRCML_STATUS_INVALID_ARGUMENT;
 
-    archive->transformations.push_back(std::unique_ptr<Transformation>(new relaxngTransformation(doc)));
+    archive->transformations.write().push_back(std::unique_ptr<Transformation>(new relaxngTransformation(doc)));
 
     return SRCML_STATUS_OK;
 }
@@ -411,11 +411,11 @@ int srcml_append_transform_param(srcml_archive* archive, const char* xpath_param
 
     if (archive == NULL || xpath_param_name == NULL || xpath_param_value == NULL)
         return SRCML_STATUS_INVALID_ARGUMENT;
-    if (archive->transformations.size() == 0)
+    if (archive->transformations->size() == 0)
         return SRCML_STATUS_NO_TRANSFORMATION;
 
-    archive->transformations.back()->xsl_parameters.push_back(xpath_param_name);
-    archive->transformations.back()->xsl_parameters.push_back(xpath_param_value);
+    archive->transformations->back()->xsl_parameters.push_back(xpath_param_name);
+    archive->transformations->back()->xsl_parameters.push_back(xpath_param_value);
 
     return SRCML_STATUS_OK;
 }
@@ -434,16 +434,16 @@ int srcml_append_transform_stringparam(srcml_archive* archive, const char* xpath
 
     if (archive == NULL || xpath_param_name == NULL || xpath_param_value == NULL)
         return SRCML_STATUS_INVALID_ARGUMENT;
-    if (archive->transformations.size() == 0)
+    if (archive->transformations->size() == 0)
         return SRCML_STATUS_NO_TRANSFORMATION;
 
-    archive->transformations.back()->xsl_parameters.push_back(xpath_param_name);
+    archive->transformations->back()->xsl_parameters.push_back(xpath_param_name);
 
     std::string parenvalue = "\"";
     parenvalue += xpath_param_value;
     parenvalue += "\"";
 
-    archive->transformations.back()->xsl_parameters.push_back(parenvalue);
+    archive->transformations->back()->xsl_parameters.push_back(parenvalue);
 
     return SRCML_STATUS_OK;
 }
@@ -462,7 +462,7 @@ int srcml_clear_transforms(srcml_archive* archive) {
         return SRCML_STATUS_INVALID_ARGUMENT;
 
     // cleanup the transformations
-    archive->transformations.clear();
+    archive->transformations.write().clear();
 
     return SRCML_STATUS_OK;
 }
@@ -510,9 +510,11 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
         return SRCML_STATUS_INVALID_ARGUMENT;
 
     // unit stays the same for no transformation
-    if (archive->transformations.empty())
+    if (archive->transformations->empty())
         return SRCML_STATUS_OK;
 
+    SRCML_STATISTICS(srcml_statistics_timer timer(archive->statistics.get(), SRCML_STAGE_TRANSFORM);)
+
     srcml_transform_result* result = nullptr;
     if (presult) {
         *presult = new srcml_transform_result;
@@ -534,7 +536,7 @@ int srcml_unit_apply_transforms(struct srcml_archive* archive, struct srcml_unit
     // final result of all applied transformations
     TransformationResult lastresult;
     std::shared_ptr<xmlDoc> curdoc(doc);
-    for (const auto& trans : archive->transformations) {
+    for (const auto& trans : *archive->transformations) {
 
         // preserve the fullresults to iterate through
         // collect results from this transformation applied to the potentially multiple
@@ -30,9 +30,70 @@
 #include "StreamMLParser.hpp"
 #include "srcMLOutput.hpp"
 #include "srcmlns.hpp"
+#include "srcMLToken.hpp"
+#include "ParseLimit.hpp"
 #include <srcml_types.hpp>
 #include <unit_utilities.hpp>
 
+namespace {
+
+    /*
+     * Tokens from the lexers to the parser. Counts the tokens into the statistics
+     * of the unit, and ends the input once over the limits of the parse.
+     */
+    class unit_token_stream : public antlr::TokenStream {
+    public:
+        unit_token_stream(antlr::TokenStream& input, ParseLimit* limit, const UTF8CharBuffer* chars)
+            : input(input), limit(limit), chars(chars) {}
+
+        antlr::RefToken nextToken() {
+
+            if (limit && limit->exceeded(chars->getSize()))
+                return antlr::RefToken(new srcMLToken(antlr::Token::EOF_TYPE, -1));
+
+            SRCML_STATISTICS_EVENT(SRCML_STAGE_LEX, 1);
+            return input.nextToken();
+        }
+
+    private:
+        antlr::TokenStream& input;
+        ParseLimit* limit;
+        const UTF8CharBuffer* chars;
+    };
+}
+
+/**
+ * output_counter
+ *
+ * Wraps the callbacks of an output buffer to count the bytes written in 64 bits.
+ * Owned by the output buffer, and freed when it is closed.
+ */
+struct srcml_translator::output_counter {
+
+    xmlOutputWriteCallback write;
+    xmlOutputCloseCallback close;
+    void* context;
+    unsigned long long written;
+
+    static int write_callback(void* context, const char* buffer, int len) {
+
+        auto counter = (output_counter*) context;
+
+        int result = counter->write(counter->context, buffer, len);
+        if (result > 0)
+            counter->written += (unsigned long long) result;
+
+        return result;
+    }
+
+    static int close_callback(void* context) {
+
+        std::unique_ptr<output_counter> counter((output_counter*) context);
+
+        return counter->close ? counter->close(counter->context) : 0;
+    }
+};
+
 /**
  * srcml_translator
  * @param output_buffer general libxml2 output buffer
@@ -74,6 +135,17 @@ srcml_translator::srcml_translator(xmlOutputBuffer * output_buffer,
       out(0, output_buffer, getLanguageString(), xml_encoding, options, attributes, processing_instruction, tabsize), tabsize(tabsize)
 {
     out.initNamespaces(namespaces);
+
+    // offsets of the unit index are counted from the bytes written
+    if ((options & SRCML_OPTION_ARCHIVE) && (options & SRCML_OPTION_INDEX) && output_buffer && output_buffer->writecallback) {
+
+        counter = new output_counter{ output_buffer->writecallback, output_buffer->closecallback, output_buffer->context,
+                                      (unsigned long long) output_buffer->written };
+
+        output_buffer->writecallback = output_counter::write_callback;
+        output_buffer->closecallback = output_counter::close_callback;
+        output_buffer->context = counter;
+    }
 }
 
 /**
@@ -82,7 +154,7 @@ srcml_translator::srcml_translator(xmlOutputBuffer * output_buffer,
  *
  * Set the user defined macro list to use.
  */
-void srcml_translator::set_macro_list(std::vector<std::string>& list) {
+void srcml_translator::set_macro_list(const std::vector<std::string>& list) {
 
     user_macro_list = list;
     out.setMacroList(list);
@@ -95,6 +167,15 @@ void srcml_translator::set_macro_list(std::vector<std::string>& list) {
  */
 void srcml_translator::close() {
 
+    // binary srcML ends with an end record instead of the end of the root unit
+    if (options & SRCML_OPTION_BINARY) {
+
+        prepareOutput();
+        binary->write_end();
+        out.close();
+        return;
+    }
+
     if (!first && (options & SRCML_OPTION_ARCHIVE) > 0)
         out.outputUnitSeparator();
 
@@ -103,15 +184,70 @@ void srcml_translator::close() {
     if (is_outputting_unit)
         add_end_unit();
 
+    // the unit index follows the end of the root unit
+    if ((options & SRCML_OPTION_ARCHIVE) && (options & SRCML_OPTION_INDEX) && out.xout && out.didwrite) {
+
+        xmlTextWriterEndDocument(out.getWriter());
+        out.didwrite = false;
+
+        std::string pi = unit_index_format(index, output_position());
+        xmlOutputBufferWrite(out.output_buffer, (int) pi.size(), pi.c_str());
+    }
+
     out.close();
 }
 
+/**
+ * output_position
+ *
+ * Byte offset in the output of the next write. Output is not flushed. The bytes
+ * already written are from the output counter. With an encoder, the output not
+ * yet converted is small, so a copy of it is converted only to measure it.
+ *
+ * @returns the position in the output.
+ */
+unsigned long long srcml_translator::output_position() {
+
+    xmlOutputBufferPtr output = out.output_buffer;
+
+    unsigned long long written = counter ? counter->written : (unsigned long long) output->written;
+
+    size_t pending = xmlOutputBufferGetSize(output);
+    if (!output->encoder)
+        return written + pending;
+
+    // converted, but not yet written
+    unsigned long long position = written + (output->conv ? xmlBufUse(output->conv) : 0);
+    if (!pending || xmlStrcasecmp(BAD_CAST output->encoder->name, BAD_CAST "UTF-8") == 0)
+        return position + pending;
+
+    if (!position_encoder)
+        position_encoder = xmlFindCharEncodingHandler(output->encoder->name);
+
+    xmlBufferPtr in = xmlBufferCreateSize(pending);
+    xmlBufferPtr converted = xmlBufferCreateSize(2 * pending);
+    if (position_encoder && in && converted) {
+
+        xmlBufferAdd(in, xmlOutputBufferGetContent(output), (int) pending);
+        xmlCharEncOutFunc(position_encoder, converted, in);
+        position += xmlBufferLength(converted);
+    }
+    xmlBufferFree(in);
+    xmlBufferFree(converted);
+
+    return position;
+}
+
 /**
  * translate
+ * @param parser_input the input to translate
+ * @param limit limits on the parse, or 0 for none
  *
  * Translate a single unit and output.  No xml declaration is added.
+ * When a limit is exceeded, the parse ends early and the rest of the
+ * input is still read, for the hash and any kept text.
  */
-void srcml_translator::translate(UTF8CharBuffer* parser_input) {
+void srcml_translator::translate(UTF8CharBuffer* parser_input, ParseLimit* limit) {
 
     first = false;
 
@@ -139,8 +275,16 @@ void srcml_translator::translate(UTF8CharBuffer* parser_input) {
         selector.addInputStream(&textlexer, "text");
         selector.select(&lexer);
 
+        // tokens between the lexers and the parser
+        unit_token_stream tokens(selector, limit, parser_input);
+
+        // keep the text of input that cannot be read again in case the parse ends early
+        if (limit && limit->keep_text)
+            parser_input->keepText(&limit->text);
+
         // base stream parser srcML connected to lexical analyzer
-        StreamMLParser parser(selector, getLanguage(), options);
+        StreamMLParser parser(tokens, getLanguage(), options);
+        parser.parse_limit = limit;
 
         // connect local parser to attribute for output
         out.setTokenStream(parser);
@@ -148,6 +292,10 @@ void srcml_translator::translate(UTF8CharBuffer* parser_input) {
         // parse and form srcML output with unit attributes
         out.consume(getLanguageString(), revision, url, filename, version, timestamp, hash, encoding);
 
+        // parse ended early, so the rest of the input is still needed for the hash and kept text
+        if (limit && limit->getReason())
+            parser_input->readText(nullptr);
+
     } catch (const std::exception& e) {
         fprintf(stderr, "SRCML Exception: %s\n", e.what());
     }
@@ -165,6 +313,15 @@ void srcml_translator::prepareOutput() {
         return;
     first = false;
 
+    // binary srcML has a header record instead of the XML declaration and root unit
+    if (options & SRCML_OPTION_BINARY) {
+
+        binary.reset(new srcml_binary_writer(out.output_buffer));
+        binary->write_header(out.xml_encoding, revision, getLanguage() ? getLanguageString() : 0, url, version,
+                             options, tabsize, out.processing_instruction, attributes, namespaces, user_macro_list);
+        return;
+    }
+
     bool is_archive = (options & SRCML_OPTION_ARCHIVE) > 0;
 
     if ((options & SRCML_OPTION_NO_XML_DECL) == 0)
@@ -198,31 +355,25 @@ bool srcml_translator::add_unit(const srcml_unit* unit) {
 
     prepareOutput();
 
+    // binary srcML stores the unit as is, and forms the unit start tag when read as XML
+    if (binary) {
+        binary->write_unit(unit);
+        return true;
+    }
+
     // space between the previous unit and this one
     if ((options & SRCML_OPTION_ARCHIVE) > 0) {
         out.outputUnitSeparator();
     }
 
-    // if the unit has namespaces, then use those
-    Namespaces mergedns = unit->archive->namespaces;
-
-    if (unit->namespaces) {
-        mergedns += *unit->namespaces;
-    }
-
-    // if a srcdiff revision, remove the srcdiff namespace
-    if (unit->archive->revision_number) {
-        auto&& view = mergedns.get<nstags::uri>();
-        auto it = view.find(SRCML_DIFF_NS_URI);
-        if (it != view.end()) {
-            view.erase(it);
-        }
-    }
+    // record where the unit starts for the unit index
+    bool indexed = (options & SRCML_OPTION_ARCHIVE) && (options & SRCML_OPTION_INDEX);
+    unsigned long long unit_start = indexed ? output_position() : 0;
 
     std::string language = unit->language ? *unit->language : Language(unit->derived_language).getLanguageString();
 
     // create a new unit start tag with all new info (hash value, namespaces actually used, etc.)
-    out.initNamespaces(mergedns);
+    init_unit_namespaces(unit);
     auto nrevision = unit->archive->revision_number;
     out.startUnit(language.c_str(),
             (options & SRCML_OPTION_ARCHIVE) && unit->revision ? unit->revision->c_str() : revision,
@@ -251,9 +402,72 @@ bool srcml_translator::add_unit(const srcml_unit* unit) {
     // end the unit
     xmlTextWriterEndElement(out.getWriter());
 
+    if (indexed) {
+
+        unit_index_entry entry;
+        entry.offset = unit_start;
+        entry.length = output_position() - unit_start;
+        entry.loc = unit->loc;
+        entry.language = language;
+        if (unit->hash)
+            entry.hash = nrevision ? attribute_revision(*unit->hash, (int) *nrevision) : *unit->hash;
+        if (unit->filename)
+            entry.filename = nrevision ? attribute_revision(*unit->filename, (int) *nrevision) : *unit->filename;
+
+        index.push_back(std::move(entry));
+    }
+
     return true;
 }
 
+/**
+ * init_unit_namespaces
+ * @param unit the unit to output
+ *
+ * Set the output namespaces to the archive namespaces merged with the unit namespaces.
+ * The merge copies multi_index containers, so the results are kept and reused for units
+ * with the same archive and unit namespaces.
+ */
+void srcml_translator::init_unit_namespaces(const srcml_unit* unit) {
+
+    bool remove_srcdiff = (bool) unit->archive->revision_number;
+
+    for (const auto& merged : merged_cache) {
+
+        if (merged.remove_srcdiff != remove_srcdiff || !equal_namespaces(merged.archive, unit->archive->namespaces))
+            continue;
+
+        if (bool(merged.unit) != bool(unit->namespaces) || (unit->namespaces && !equal_namespaces(*merged.unit, *unit->namespaces)))
+            continue;
+
+        out.setNamespaces(merged.output);
+        return;
+    }
+
+    // if the unit has namespaces, then use those
+    Namespaces mergedns = unit->archive->namespaces;
+
+    if (unit->namespaces) {
+        mergedns += *unit->namespaces;
+    }
+
+    // if a srcdiff revision, remove the srcdiff namespace
+    if (remove_srcdiff) {
+        auto&& view = mergedns.get<nstags::uri>();
+        auto it = view.find(SRCML_DIFF_NS_URI);
+        if (it != view.end()) {
+            view.erase(it);
+        }
+    }
+
+    out.initNamespaces(mergedns);
+
+    if (merged_cache.size() >= MERGED_NAMESPACES_SIZE)
+        merged_cache.erase(merged_cache.begin());
+
+    merged_cache.push_back({ unit->archive->namespaces, unit->namespaces, remove_srcdiff, out.getNamespaces() });
+}
+
 /**
  * add_start_unit
  * @param unit srcML to add to archive/non-archive with configuration options
@@ -440,4 +654,8 @@ bool srcml_translator::add_string(const char *content) {
  *
  * Destructor.
  */
-srcml_translator::~srcml_translator() {}
+srcml_translator::~srcml_translator() {
+
+    if (position_encoder)
+        xmlCharEncCloseFunc(position_encoder);
+}
@@ -31,9 +31,11 @@
 #include <srcMLOutput.hpp>
 #include <srcml_types.hpp>
 #include <srcml_macros.hpp>
+#include <srcml_binary.hpp>
 #include <srcml.h>
 
 #include <string>
+#include <vector>
 
 /**
  * FileError
@@ -45,6 +47,9 @@ class FileError {};
 /** Forward declaration of input buffer type */
 class UTF8CharBuffer;
 
+/** Forward declaration of limits on a parse */
+class ParseLimit;
+
 /**
 * srcml_translator
 *
@@ -72,11 +77,11 @@ public:
                      const char* hash,
                      const char* encoding);
 
-    void set_macro_list(std::vector<std::string> & list);
+    void set_macro_list(const std::vector<std::string>& list);
 
     void close();
 
-    void translate(UTF8CharBuffer* parser_input);
+    void translate(UTF8CharBuffer* parser_input, ParseLimit* limit = 0);
 
     bool add_unit(const srcml_unit* unit);
     bool add_start_unit(const srcml_unit* unit);
@@ -145,6 +150,41 @@ private:
     /** mark if have outputted starting unit tag for by element writing */
     bool is_outputting_unit = false;
 
+    /** writer of binary srcML, instead of the srcML output */
+    std::unique_ptr<srcml_binary_writer> binary;
+
+    /** units added to the archive, for the unit index */
+    std::vector<unit_index_entry> index;
+
+    /** counter of the bytes written by the output buffer, which only counts up to INT_MAX */
+    struct output_counter;
+    output_counter* counter = nullptr;
+
+    /** separate encoder to measure the encoded size of output not yet converted */
+    xmlCharEncodingHandlerPtr position_encoder = nullptr;
+
+    unsigned long long output_position();
+
+    /**
+     * merged_namespaces
+     *
+     * Output namespaces of a unit, by the namespaces they were merged from
+     */
+    struct merged_namespaces {
+        Namespaces archive;
+        boost::optional<Namespaces> unit;
+        bool remove_srcdiff;
+        Namespaces output;
+    };
+
+    /** maximum number of distinct merges to keep */
+    static const size_t MERGED_NAMESPACES_SIZE = 8;
+
+    /** merges of previous units, as most units repeat the same few */
+    std::vector<merged_namespaces> merged_cache;
+
+    void init_unit_namespaces(const srcml_unit* unit);
+
 public:
     /** track depth for by element writing */
     int output_unit_depth = 0;
@@ -31,6 +31,7 @@
 #include <libexslt/exslt.h>
 
 #include <Transformation.hpp>
+#include <copy_on_write.hpp>
 
 #include <memory>
 
@@ -52,6 +53,10 @@ const unsigned int SRCML_OPTION_CPP_DECLARED      = 1<<13;
 const unsigned int SRCML_OPTION_ARCHIVE           = 1<<14;
  /** Output hash attribute on each unit (default: on) */
 const unsigned int SRCML_OPTION_HASH              = 1<<15;
+ /** Output a unit index after the root unit (default: off) */
+const unsigned int SRCML_OPTION_INDEX             = 1<<16;
+ /** Output binary srcML instead of XML (default: off) */
+const unsigned int SRCML_OPTION_BINARY            = 1<<17;
 
 /** All default enabled options */
 const unsigned int SRCML_OPTION_DEFAULT_INTERNAL  = (SRCML_OPTION_ARCHIVE | SRCML_OPTION_HASH | SRCML_OPTION_NAMESPACE_DECL);
@@ -60,10 +65,13 @@ const unsigned int SRCML_OPTION_DEFAULT_INTERNAL  = (SRCML_OPTION_ARCHIVE | SRCM
 
 #include <Language.hpp>
 #include <language_extension_registry.hpp>
+#include <unit_index.hpp>
+#include <srcml_statistics.hpp>
 
 #include <boost/optional.hpp>
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifdef __GNUC__
@@ -91,7 +99,9 @@ typedef unsigned __int64 OPTION_TYPE;
 #endif
 
 class srcml_sax2_reader;
+class srcml_binary_reader;
 class srcml_translator;
+class srcml_async_writer;
 
 /**
  * SRCML_ARCHIVE_TYPE
@@ -104,6 +114,8 @@ enum SRCML_ARCHIVE_TYPE { SRCML_ARCHIVE_INVALID, SRCML_ARCHIVE_RW, SRCML_ARCHIVE
  * srcml_archive
  *
  * Holds data for a srcML archive read/write.
+ * The configuration, e.g., namespaces and registered languages, is
+ * shared with clones of the archive, and copied on the first change.
  */
 struct srcml_archive {
 
@@ -123,7 +135,7 @@ struct srcml_archive {
     /** an attribute for a version string */
     boost::optional<std::string> version;
     /** an array of name-value attribute pairs */
-    std::vector<std::string> attributes;
+    copy_on_write<std::vector<std::string>> attributes;
 
     /** srcml options */
     OPTION_TYPE options = SRCML_OPTION_DEFAULT_INTERNAL;
@@ -131,17 +143,21 @@ struct srcml_archive {
     /** size of tabstop */
     size_t tabstop = 8;
 
+    /** limits on the parse of each unit, time in milliseconds and size in bytes, 0 for none */
+    unsigned int parse_time_limit = 0;
+    size_t parse_size_limit = 0;
+
     /**  new namespace structure */
-    Namespaces namespaces = starting_namespaces;
+    copy_on_write<Namespaces> namespaces = starting_namespaces;
 
     /** target/data pair for processing instruction */
     boost::optional<std::pair<std::string, std::string> > processing_instruction;
 
     /** an array of registered extension language pairs */
-    language_extension_registry registered_languages = language_extension_registry();
+    copy_on_write<language_extension_registry> registered_languages;
 
     /** an array of user defined macros and their types */
-    std::vector<std::string> user_macro_list;
+    copy_on_write<std::vector<std::string>> user_macro_list;
 
     /** a srcMLTranslator for writing and parsing */
     srcml_translator* translator = nullptr;
@@ -149,7 +165,11 @@ struct srcml_archive {
     /** a srcMLReader for reading */
     srcml_sax2_reader* reader = nullptr;
 
-    std::vector<std::shared_ptr<Transformation>> transformations;
+    /** a reader for binary srcML, instead of the reader */
+    srcml_binary_reader* binary_reader = nullptr;
+
+    /** transformations to apply, in order */
+    copy_on_write<std::vector<std::shared_ptr<Transformation>>> transformations;
 
     /** srcDiff revision number */
     boost::optional<size_t> revision_number;
@@ -165,6 +185,25 @@ struct srcml_archive {
     /** raw writes were made */
     bool rawwrites = false;
 
+    /** unit index read from the end of the archive, and the position in it of the first unit of each filename */
+    copy_on_write<std::vector<unit_index_entry>> unit_index;
+    copy_on_write<std::unordered_map<std::string, size_t>> unit_index_filenames;
+
+    /** input file or memory, for random access to units using the unit index */
+    boost::optional<std::string> input_filename;
+    const char* input_buffer = nullptr;
+    size_t input_size = 0;
+
+    /** maximum number of units queued for writing on a background thread, 0 for synchronous writes */
+    size_t write_queue_size = 0;
+
+    /** background writer of units, when writes are asynchronous */
+    std::shared_ptr<srcml_async_writer> async_writer;
+
+    /** statistics of the stages of the pipeline, and the last report of them */
+    std::shared_ptr<srcml_statistics> statistics = std::make_shared<srcml_statistics>();
+    std::string statistics_report;
+
     /** error reporting */
     std::string error_string;
     int error_number = 0;
@@ -218,6 +257,9 @@ struct srcml_unit {
     // if body has been read
     bool read_body = false;
 
+    // if body was collected when the unit was parsed, so it can be read
+    bool has_body = false;
+
     /** srcml from read and after parsing */
     std::string srcml;
     boost::optional<std::string> srcml_revision;
@@ -23,12 +23,18 @@
 #include <srcml_translator.hpp>
 #include <srcml_sax2_reader.hpp>
 #include <UTF8CharBuffer.hpp>
+#include <ParseLimit.hpp>
 #include <memory>
 #include <libxml2_utilities.hpp>
 #include <cstring>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <srcml_macros.hpp>
 
+#ifndef _MSC_BUILD
+#include <unistd.h>
+#endif
+
 /******************************************************************************
  *                                                                            *
  *                           Set up functions                                 *
@@ -345,6 +351,8 @@ const char* srcml_unit_get_srcml(struct srcml_unit* unit) {
 
     if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
         unit->archive->reader->read_body(unit);
+    if (!unit->read_body)
+        return 0;
 
     if (unit->archive->revision_number && issrcdiff(unit->archive->namespaces)) {
         if (!unit->srcml_revision || unit->currevision != (int) *unit->archive->revision_number)
@@ -374,6 +382,8 @@ const char* srcml_unit_get_srcml_outer(struct srcml_unit* unit) {
 
     if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
         unit->archive->reader->read_body(unit);
+    if (!unit->read_body)
+        return 0;
 
     // size of resulting raw version (no unit tag)
     auto rawsize = unit->srcml.size() - (unit->insert_end - unit->insert_begin);
@@ -441,6 +451,8 @@ const char* srcml_unit_get_srcml_inner(struct srcml_unit* unit) {
 
     if (!unit->read_body && (unit->archive->type == SRCML_ARCHIVE_READ || unit->archive->type == SRCML_ARCHIVE_RW))
         unit->archive->reader->read_body(unit);
+    if (!unit->read_body)
+        return 0;
 
     auto start = unit->content_begin;
 
@@ -471,34 +483,103 @@ const char* srcml_unit_get_srcml_inner(struct srcml_unit* unit) {
  *                                                                            *
  ******************************************************************************/
 
+/**
+ * srcml_unit_input_size
+ * @param fd a file descriptor open for reading
+ *
+ * Size of the rest of the input of a regular file.
+ *
+ * @returns the size, or none if not a regular file
+ */
+static boost::optional<size_t> srcml_unit_input_size(int fd) {
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return boost::none;
+
+    auto offset = lseek(fd, 0, SEEK_CUR);
+    if (offset < 0 || offset > st.st_size)
+        return boost::none;
+
+    return (size_t) (st.st_size - offset);
+}
+
+/**
+ * srcml_unit_input_size
+ * @param file a FILE open for reading
+ *
+ * Size of the rest of the input of a regular file.
+ *
+ * @returns the size, or none if not a regular file
+ */
+static boost::optional<size_t> srcml_unit_input_size(FILE* file) {
+
+    struct stat st;
+    if (fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode))
+        return boost::none;
+
+    auto offset = ftell(file);
+    if (offset < 0 || offset > st.st_size)
+        return boost::none;
+
+    return (size_t) (st.st_size - offset);
+}
+
+/**
+ * srcml_unit_read_text
+ * @param input the source input
+ *
+ * Read the rest of the input without parsing it.
+ *
+ * @returns the text of the input
+ */
+static std::string srcml_unit_read_text(UTF8CharBuffer* input) {
+
+    std::string text;
+    try {
+
+        input->readText(&text);
+
+    } catch (...) {}
+
+    return text;
+}
+
 /**
  * srcml_unit_parse_internal
  * @param unit a srcml unit
- * @param lang an interger representation of a language
- * @param input the source input to the translator
- * @param translation_options the options for translation
+ * @param filename name of the source file, if any
+ * @param createUTF8CharBuffer creates the source input to the translator
+ * @param input_size size of the source input, if known
+ * @param reopenUTF8CharBuffer creates the source input again from the start, if possible
  *
  * Function for internal use for parsing functions. Creates
  * output buffer, translates a current input and places the
- * contents into the unit.
+ * contents into the unit. Input of a known size over the size
+ * limit is not parsed, and forms the unit from its text.
  *
  * @returns Returns SRCML_STATUS_OK on success and SRCML_STATUS_IO_ERROR on failure.
  */
 static int srcml_unit_parse_internal(struct srcml_unit* unit, const char* filename,
-    std::function<UTF8CharBuffer*(const char* src_encoding, bool output_hash, boost::optional<std::string>& hash)> createUTF8CharBuffer) {
+    std::function<UTF8CharBuffer*(const char* src_encoding, bool output_hash, boost::optional<std::string>& hash)> createUTF8CharBuffer,
+    boost::optional<size_t> input_size = boost::none,
+    std::function<UTF8CharBuffer*(const char* src_encoding)> reopenUTF8CharBuffer = nullptr) {
 
     // figure out the language based on unit, archive, registered languages
     int lang = unit->language ? srcml_check_language(unit->language->c_str())
         : (unit->archive->language ? srcml_check_language(unit->archive->language->c_str()) : SRCML_LANGUAGE_NONE);
 
     if (lang == SRCML_LANGUAGE_NONE && filename)
-        lang = unit->archive->registered_languages.get_language_from_filename(filename);
+        lang = unit->archive->registered_languages->get_language_from_filename(filename);
 
     if (lang == SRCML_LANGUAGE_NONE)
         return SRCML_STATUS_UNSET_LANGUAGE;
 
     unit->derived_language = lang;
 
+    // statistics of parsing this unit, added to the archive when done
+    SRCML_STATISTICS(srcml_unit_statistics_scope statistics_scope(unit->archive->statistics.get(), optional_to_c_str(unit->filename, filename));)
+
     const char* src_encoding = optional_to_c_str(unit->encoding, optional_to_c_str(unit->archive->src_encoding));
 
     // verify encoding here instead of later, when more difficult to handle errors
@@ -532,12 +613,73 @@ static int srcml_unit_parse_internal(struct srcml_unit* unit, const char* filena
     if (status != SRCML_STATUS_OK)
         return status;
 
-    // parse the input
-    unit->unit_translator->translate(input);
+    // error attribute for a parse that exceeds a limit, without any from a previous parse
+    auto& error_view = unit->namespaces->get<nstags::uri>();
+    auto error_ns = error_view.find(SRCML_ERROR_NS_URI);
+    std::string limit_attribute = error_ns != error_view.end() && !error_ns->prefix.empty() ? error_ns->prefix + ":parse" : "parse";
+    for (size_t pos = 0; pos < unit->attributes.size(); pos += 2) {
+        if (unit->attributes[pos] == limit_attribute) {
+            unit->attributes.erase(unit->attributes.begin() + pos, unit->attributes.begin() + pos + 2);
+            break;
+        }
+    }
+
+    // limits on the parse of this unit
+    std::unique_ptr<ParseLimit> limit;
+    if (unit->archive->parse_time_limit || unit->archive->parse_size_limit)
+        limit.reset(new ParseLimit(unit->archive->parse_time_limit, unit->archive->parse_size_limit));
+
+    if (limit && input_size && limit->exceeded(*input_size)) {
+
+        // over the size limit, so only read for the text
+        limit->text = srcml_unit_read_text(input);
+        delete input;
 
-    // namespaces were updated during translation, may now include
-    // namespaces that were optional
-    unit->namespaces = unit->unit_translator->out.getNamespaces();
+    } else {
+
+        // only input that cannot be read again keeps its text during the parse
+        if (limit)
+            limit->keep_text = !reopenUTF8CharBuffer;
+
+        // parse the input
+        unit->unit_translator->translate(input, limit.get());
+
+        // namespaces were updated during translation, may now include
+        // namespaces that were optional
+        unit->namespaces = unit->unit_translator->out.getNamespaces();
+
+        // parse ended early, so read the input again for the text
+        if (limit && limit->getReason() && !limit->keep_text) {
+
+            std::unique_ptr<UTF8CharBuffer> again;
+            try {
+                again.reset(reopenUTF8CharBuffer(optional_to_c_str(unit->encoding)));
+            } catch(...) {}
+
+            if (again)
+                limit->text = srcml_unit_read_text(again.get());
+        }
+    }
+
+    // parse ended at a limit, so the unit is the text of the input
+    // with the exceeded limit as an error attribute
+    if (limit && limit->getReason()) {
+
+        auto& view = unit->namespaces->get<nstags::uri>();
+        auto ns = view.find(SRCML_ERROR_NS_URI);
+        if (ns != view.end())
+            ns->flags |= NS_USED;
+
+        unit->attributes.push_back(limit_attribute);
+        unit->attributes.push_back(limit->getReason());
+
+        status = srcml_write_start_unit(unit);
+        if (status != SRCML_STATUS_OK)
+            return status;
+
+        if (!limit->text.empty())
+            srcml_write_string(unit, limit->text.c_str());
+    }
 
     // create the unit end tag
     return srcml_write_end_unit(unit);
@@ -567,6 +709,15 @@ int srcml_unit_parse_filename(struct srcml_unit* unit, const char* src_filename)
     return srcml_unit_parse_internal(unit, src_filename, [src_fd](const char* encoding, bool output_hash, boost::optional<std::string>& hash)-> UTF8CharBuffer* {
 
         return new UTF8CharBuffer(src_fd, encoding, output_hash, hash);
+
+    }, srcml_unit_input_size(src_fd), [src_filename](const char* encoding)-> UTF8CharBuffer* {
+
+        int fd = OPEN(src_filename, O_RDONLY, 0);
+        if (fd == -1)
+            return nullptr;
+
+        boost::optional<std::string> hash;
+        return new UTF8CharBuffer(fd, encoding, false, hash);
     });
 }
 
@@ -589,6 +740,11 @@ int srcml_unit_parse_memory(struct srcml_unit* unit, const char* src_buffer, siz
     return srcml_unit_parse_internal(unit, 0, [src_buffer, buffer_size](const char* encoding, bool output_hash, boost::optional<std::string>& hash)-> UTF8CharBuffer* {
 
         return new UTF8CharBuffer(src_buffer ? src_buffer : "", buffer_size, encoding, output_hash, hash);
+
+    }, buffer_size, [src_buffer, buffer_size](const char* encoding)-> UTF8CharBuffer* {
+
+        boost::optional<std::string> hash;
+        return new UTF8CharBuffer(src_buffer ? src_buffer : "", buffer_size, encoding, false, hash);
     });
 }
 
@@ -610,7 +766,8 @@ int srcml_unit_parse_FILE(struct srcml_unit* unit, FILE* src_file) {
     return srcml_unit_parse_internal(unit, 0, [src_file](const char* encoding, bool output_hash, boost::optional<std::string>& hash)-> UTF8CharBuffer* {
 
         return new UTF8CharBuffer(src_file, encoding, output_hash, hash);
-    });
+
+    }, srcml_unit_input_size(src_file));
 }
 
 /**
@@ -631,7 +788,8 @@ int srcml_unit_parse_fd(struct srcml_unit* unit, int src_fd) {
     return srcml_unit_parse_internal(unit, 0, [src_fd](const char* encoding, bool output_hash, boost::optional<std::string>& hash)-> UTF8CharBuffer* {
 
         return new UTF8CharBuffer(src_fd, encoding, output_hash, hash);
-    });
+
+    }, srcml_unit_input_size(src_fd));
 }
 
 /**
@@ -692,40 +850,69 @@ static int srcml_unit_unparse_internal(struct srcml_unit* unit, std::function<xm
         return SRCML_STATUS_IO_ERROR;
     }
 
+    // only the header of the unit was read
+    if (!unit->read_body)
+        return SRCML_STATUS_UNINITIALIZED_UNIT;
+
     // if this unit was parsed from source, then the src does not exist
     // generate this source from the srcml
     if (!unit->src) {
+        SRCML_STATISTICS(srcml_statistics_timer extract_timer(unit->archive->statistics.get(), SRCML_STAGE_EXTRACT, unit->srcml.size());)
         unit->src = extract_src(unit->srcml);
     }
 
     // if EOL is not auto, then need to convert for
-    if (unit->eol == SOURCE_OUTPUT_EOL_AUTO) {
+    const char* eol = nullptr;
+    if (unit->eol == SOURCE_OUTPUT_EOL_CR)
+        eol = "\r";
+    else if (unit->eol == SOURCE_OUTPUT_EOL_CRLF)
+        eol = "\r\n";
+
+    if (!eol) {
         xmlOutputBufferWrite(output_handler.get(), (int) unit->src->size(), unit->src->c_str());
     } else {
 
-        // convert to the given eol
-        std::string neol(0, ' ');
-        neol.reserve(unit->src->size());
+        // convert to the given eol, copying the runs between newlines into a block
+        // so that the output buffer is written in large pieces
+        const size_t eol_size = strlen(eol);
+        char block[16 * 1024];
+        size_t used = 0;
 
-        const std::string& src = *unit->src;
-        for (size_t i = 0; i < src.size(); ++i) {
-            if (src[i] != '\n') {
-                neol += src[i];
-            }
-            else if (unit->eol == SOURCE_OUTPUT_EOL_LF) {
-                neol += '\n';
-            }
-            else if (unit->eol == SOURCE_OUTPUT_EOL_CR) {
-                neol += '\r';
+        const char* p = unit->src->c_str();
+        const char* end = p + unit->src->size();
+        while (p < end) {
+
+            const char* newline = (const char*) memchr(p, '\n', end - p);
+            const char* run_end = newline ? newline : end;
+
+            // copy this run, writing out full blocks
+            while (p < run_end) {
+
+                size_t size = std::min((size_t) (run_end - p), sizeof(block) - used);
+                memcpy(block + used, p, size);
+                used += size;
+                p += size;
+
+                if (used == sizeof(block)) {
+                    xmlOutputBufferWrite(output_handler.get(), (int) used, block);
+                    used = 0;
+                }
             }
-            else if (unit->eol == SOURCE_OUTPUT_EOL_CRLF) {
-                neol += "\r\n";
-            } else {
-                neol += src[i];
+
+            if (!newline)
+                break;
+
+            if (used + eol_size > sizeof(block)) {
+                xmlOutputBufferWrite(output_handler.get(), (int) used, block);
+                used = 0;
             }
+            memcpy(block + used, eol, eol_size);
+            used += eol_size;
+            ++p;
         }
 
-        xmlOutputBufferWrite(output_handler.get(), (int) neol.size(), neol.c_str());
+        if (used)
+            xmlOutputBufferWrite(output_handler.get(), (int) used, block);
     }
 
     return SRCML_STATUS_OK;
@@ -886,9 +1073,10 @@ int srcml_write_start_unit(struct srcml_unit* unit) {
 
     // setup the translator (srcML parser + srcML output)
     try {
-        // turn off option for archive so XML generated has full namespaces
+        // turn off option for archive so XML generated has full namespaces,
+        // and a unit is always XML
         auto options = unit->archive->options;
-        options &= ~(unsigned long long)(SRCML_OPTION_ARCHIVE);
+        options &= ~(unsigned long long)(SRCML_OPTION_ARCHIVE | SRCML_OPTION_BINARY);
 
         if (!(unit->namespaces))
             unit->namespaces = unit->archive->namespaces;
@@ -963,6 +1151,8 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
     if (unit->unit_translator == nullptr)
         return SRCML_STATUS_INVALID_INPUT;
 
+    SRCML_STATISTICS(srcml_statistics_timer timer(unit->archive->statistics.get(), SRCML_STAGE_FINALIZE);)
+
     // end any open content
     while (unit->unit_translator->output_unit_depth)
         unit->unit_translator->add_end_element();
@@ -985,6 +1175,9 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
     int content_begin = unit->content_begin;
     int content_end = unit->content_end;
 
+    // position attributes of start tags that were output before their end was known
+    auto deferred_positions = std::move(unit->unit_translator->out.getDeferredPositions());
+
     // redo the start element with the namespaces found in the document
     srcml_write_start_unit(unit);
     char* start_tag = (char*) xmlBufferDetach(unit->output_buffer);
@@ -995,7 +1188,16 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
 
     if (content_begin != content_end) {
         unit->srcml.append(">");
-        unit->srcml.append(srcml + content_begin);
+
+        // insert the deferred position attributes into their start tags
+        int pos = content_begin;
+        for (const auto& deferred : deferred_positions) {
+            unit->srcml.append(srcml + pos, deferred.offset - pos);
+            unit->srcml.append(deferred.attributes);
+            unit->content_end += (int) deferred.attributes.size();
+            pos = deferred.offset;
+        }
+        unit->srcml.append(srcml + pos);
     } else {
         unit->srcml.append("/>");
     }
@@ -1008,6 +1210,7 @@ int srcml_write_end_unit(struct srcml_unit* unit) {
 
     // record the loc
     if (!unit->src) {
+        SRCML_STATISTICS(srcml_statistics_timer extract_timer(unit->archive->statistics.get(), SRCML_STAGE_EXTRACT, unit->srcml.size());)
         unit->src = extract_src(unit->srcml);
     }
 
@@ -103,6 +103,32 @@ std::string& srcml_uri_normalize(std::string& uri) {
     return uri;
 }
 
+/**
+ * equal_namespaces
+ * @param namespaces the namespaces to compare
+ * @param otherns the namespaces to compare to
+ * @param compare_flags also compare the flags of each namespace
+ *
+ * Compare namespaces by position, without the allocation of a merge.
+ *
+ * @returns if the namespaces have the same prefixes and URIs, and flags if compared, in the same order
+ */
+bool equal_namespaces(const Namespaces& namespaces, const Namespaces& otherns, bool compare_flags) {
+
+    if (namespaces.size() != otherns.size())
+        return false;
+
+    for (Namespaces::size_type i = 0; i < namespaces.size(); ++i) {
+
+        const auto& ns = namespaces[i];
+        const auto& other = otherns[i];
+        if (ns.uri != other.uri || ns.prefix != other.prefix || (compare_flags && ns.flags != other.flags))
+            return false;
+    }
+
+    return true;
+}
+
 bool issrcdiff(const Namespaces& namespaces) {
    auto& view = namespaces.get<nstags::uri>();
    return view.find(SRCML_DIFF_NS_URI) != view.end();
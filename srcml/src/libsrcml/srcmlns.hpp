@@ -172,6 +172,9 @@ std::string& srcml_uri_normalize(std::string & uri);
 // merge in the other namespace
 Namespaces& operator +=(Namespaces& ns, const Namespaces& otherns);
 
+// same namespaces in the same order, optionally with the same flags
+bool equal_namespaces(const Namespaces& namespaces, const Namespaces& otherns, bool compare_flags = true);
+
 // is a srcdiff archive
 bool issrcdiff(const Namespaces& namespaces);
 
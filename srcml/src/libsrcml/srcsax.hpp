@@ -25,6 +25,8 @@
 #include <libxml/parser.h>
 #include <libxml2_utilities.hpp>
 
+struct sax2_srcsax_handler;
+
 /**
  * srcsax_context
  *
@@ -49,11 +51,14 @@ public:
 
     /* Internal context handling NOT FOR PUBLIC USE */
 
-    /** xml parser input buffer */
+    /** xml parser input buffer, read in chunks and pushed to the parser */
     std::unique_ptr<xmlParserInputBuffer> input;
 
-    /** internally used libxml2 context */
+    /** internally used libxml2 push parser context */
     xmlParserCtxtPtr libxml2_context = nullptr;
+
+    /** internal SAX parsing state, kept between chunks */
+    sax2_srcsax_handler* state = nullptr;
 };
 
 /* srcSAX context creation/open functions */
@@ -65,6 +70,9 @@ void srcsax_free_context(srcsax_context * context);
 /* srcSAX parse function */
 int srcsax_parse(srcsax_context * context);
 
+/* srcSAX incremental parse function */
+int srcsax_parse_chunk(srcsax_context * context);
+
 /* srcSAX terminate parse function */
 void srcsax_stop_parser(srcsax_context* context);
 
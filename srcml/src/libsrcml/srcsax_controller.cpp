@@ -23,6 +23,7 @@
 #include <libxml/parserInternals.h>
 
 #include <functional>
+#include <algorithm>
 #include <cstring>
 
 /**
@@ -38,17 +39,19 @@ static void libxml_error(void * /*ctx*/, const char* msg, ...) {
     va_end(vl);
 }
 
+/** size of the chunks of input pushed to the parser */
+static const size_t SRCSAX_CHUNK_SIZE = 16384;
+
 /* srcsax_create_parser_context forward declaration */
-static xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input, xmlCharEncoding enc);
+static xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input);
 
 /**
  * srcsax_create_context_parser_input_buffer
- * @param srcml_context an opened context for opened srcML document
- * @param read_callback a read callback function
- * @close_callback a close callback function
- * @param encoding the files character encoding
+ * @param input a parser input buffer
  *
- * Create a srcsSAX context from a general context and read/close callbacks with the specified encoding.
+ * Create a srcsSAX context from a parser input buffer. The input is read
+ * in chunks and pushed to the parser, so parsing proceeds on the thread
+ * that calls srcsax_parse_chunk().
  *
  * @returns srcsax_context context to be used for srcML parsing.
  */
@@ -57,8 +60,6 @@ srcsax_context* srcsax_create_context_parser_input_buffer(std::unique_ptr<xmlPar
     if (!input)
         return 0;
 
-    const char* encoding = nullptr;
-
     xmlGenericErrorFunc error_handler = (xmlGenericErrorFunc) libxml_error;
     initGenericErrorDefaultFunc(&error_handler);
 
@@ -71,7 +72,7 @@ srcsax_context* srcsax_create_context_parser_input_buffer(std::unique_ptr<xmlPar
 
     context->input = std::move(input);
 
-    xmlParserCtxtPtr libxml2_context = srcsax_create_parser_context(context->input.release(), encoding ? xmlParseCharEncoding(encoding) : XML_CHAR_ENCODING_NONE);
+    xmlParserCtxtPtr libxml2_context = srcsax_create_parser_context(context->input.get());
     if (libxml2_context == nullptr) {
         delete context;
         return 0;
@@ -97,6 +98,8 @@ void srcsax_free_context(srcsax_context* context) {
     if (context->libxml2_context)
         xmlFreeParserCtxt(context->libxml2_context);
 
+    delete context->state;
+
     delete context;
 }
 
@@ -104,69 +107,115 @@ void srcsax_free_context(srcsax_context* context) {
  * srcsax_parse
  * @param context srcSAX context
  *
- * Parse the context using the provide sax handlers.
+ * Parse the entire context using the provide sax handlers.
  * On error calls the error callback function before returning.
  *
  * @returns 0 on success -1 on error.
  */
 int srcsax_parse(srcsax_context* context) {
 
+    int status = 0;
+    while ((status = srcsax_parse_chunk(context)) > 0)
+        ;
+
+    return status;
+}
+
+/**
+ * srcsax_parse_chunk
+ * @param context srcSAX context
+ *
+ * Push the next chunk of input to the parser using the provide sax handlers.
+ * All SAX callbacks for the chunk are made before returning, so the caller
+ * can process what was parsed before parsing more.
+ * On error calls the error callback function before returning.
+ *
+ * @returns 1 if there is more to parse, 0 at the end of the document, and -1 on error.
+ */
+int srcsax_parse_chunk(srcsax_context* context) {
+
     if (context == 0 || context->handler == 0)
         return -1;
 
-    xmlSAXHandlerPtr save_sax = context->libxml2_context->sax;
+    xmlParserCtxtPtr ctxt = context->libxml2_context;
 
-    xmlSAXHandler sax = srcsax_sax2_factory();
-    context->libxml2_context->sax = &sax;
+    // sax handling and its state persists over all chunks
+    if (context->state == 0) {
 
-    sax2_srcsax_handler state;
-    state.context = context;
-    context->libxml2_context->_private = &state;
+        *ctxt->sax = srcsax_sax2_factory();
 
-    int status = xmlParseDocument(context->libxml2_context);
+        context->state = new sax2_srcsax_handler();
+        context->state->context = context;
+        ctxt->_private = context->state;
+    }
+
+    // reached the end of the document, or parsing was stopped
+    if (ctxt->instate == XML_PARSER_EOF)
+        return 0;
+
+    // read more when all of the previous input was pushed
+    xmlParserInputBufferPtr input = context->input.get();
+    if (xmlBufUse(input->buffer) == 0)
+        xmlParserInputBufferGrow(input, (int) SRCSAX_CHUNK_SIZE);
+
+    // limit the chunk size, even when the entire input is already in memory
+    int size = (int) std::min(xmlBufUse(input->buffer), SRCSAX_CHUNK_SIZE);
+    int terminate = size == 0;
+
+    int status = xmlParseChunk(ctxt, (const char*) xmlBufContent(input->buffer), size, terminate);
+
+    xmlBufShrink(input->buffer, size);
 
-    context->libxml2_context->sax = save_sax;
+    if (status != 0) {
 
-    if (status != 0 && context->srcsax_error) {
+        if (context->srcsax_error) {
 
-        xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
+            xmlErrorPtr ep = xmlCtxtGetLastError(context->libxml2_context);
 
-        auto str_length = strlen(ep->message);
-        ep->message[str_length - 1] = '\0';
+            auto str_length = strlen(ep->message);
+            ep->message[str_length - 1] = '\0';
 
-        context->srcsax_error((const char *)ep->message, ep->code);
+            context->srcsax_error((const char *)ep->message, ep->code);
+        }
+
+        return -1;
     }
 
-    return status;
+    return terminate || ctxt->instate == XML_PARSER_EOF ? 0 : 1;
 }
 
 /**
  * srcsax_create_parser_context
  * @param buffer_input a parser input buffer
  *
- * Create a ctxt from a parser input buffer.
- * Modeled after function in libxml2.
+ * Create a push parser ctxt for the input from a parser input buffer.
+ * Any encoding of the parser input buffer is already applied to the
+ * chunks, so the encoding in the XML declaration is ignored.
  *
  * @returns xml parser ctxt
  */
-xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input, xmlCharEncoding enc) {
+xmlParserCtxtPtr srcsax_create_parser_context(xmlParserInputBufferPtr buffer_input) {
 
     if (buffer_input == 0)
         return 0;
 
-    xmlParserCtxtPtr ctxt = xmlNewParserCtxt();
+    // the first bytes are needed to detect the encoding
+    if (xmlBufUse(buffer_input->buffer) < 4)
+        xmlParserInputBufferGrow(buffer_input, (int) SRCSAX_CHUNK_SIZE);
+
+    int size = (int) std::min(xmlBufUse(buffer_input->buffer), (size_t) 4);
+
+    xmlParserCtxtPtr ctxt = xmlCreatePushParserCtxt(0, 0, (const char*) xmlBufContent(buffer_input->buffer), size, 0);
     if (ctxt == 0)
         return 0;
 
-    xmlCtxtUseOptions(ctxt, XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT);
+    xmlBufShrink(buffer_input->buffer, size);
 
-    xmlParserInputPtr input = xmlNewIOInputStream(ctxt, buffer_input, enc);
-    if (input == 0) {
-        xmlFreeParserCtxt(ctxt);
-        return 0;
-    }
+    int options = XML_PARSE_COMPACT | XML_PARSE_HUGE | XML_PARSE_NODICT;
+    if (buffer_input->encoder)
+        options |= XML_PARSE_IGNORE_ENC;
 
-    inputPush(ctxt, input);
+    xmlCtxtUseOptions(ctxt, options);
 
     return ctxt;
 }
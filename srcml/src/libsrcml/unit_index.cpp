@@ -0,0 +1,450 @@
+/**
+ * @file unit_index.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <unit_index.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+
+#if defined(_MSC_VER)
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
+
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+/*
+  The unit index is a processing instruction after the end of the root unit:
+
+    <?srcml-index offset length loc language hash filename
+    <offset> <length> <loc> <language> <hash> <filename>
+    ...
+    <offset of the index>?>
+
+  One line per unit, in archive order. A missing language or hash is "-", and
+  the filename is the rest of the line. The filename is percent-encoded so that
+  the index is plain ASCII, independent of the output encoding. The last line is
+  the byte offset of the index itself, so that it is found from the end of the file.
+*/
+
+namespace {
+
+    /** first line of the unit index */
+    const char UNIT_INDEX_HEADER[] = "<?srcml-index offset length loc language hash filename\n";
+
+    /** maximum size of the last line of the unit index */
+    const size_t UNIT_INDEX_TRAILER_SIZE = 32;
+
+    // append the filename with characters that would end the index, and all non-ASCII, escaped
+    void append_escaped(std::string& s, const std::string& filename) {
+
+        static const char hex[] = "0123456789ABCDEF";
+
+        for (unsigned char c : filename) {
+
+            if (c == '%' || c == '>' || c == '\n' || c == '\r' || c >= 0x80) {
+                s += '%';
+                s += hex[c >> 4];
+                s += hex[c & 0x0F];
+            } else {
+                s += (char) c;
+            }
+        }
+    }
+
+    int hex_value(char c) {
+
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+
+        return -1;
+    }
+
+    bool unescape(const char* first, const char* last, std::string& filename) {
+
+        filename.clear();
+        for (const char* p = first; p < last; ++p) {
+
+            if (*p != '%') {
+                filename += *p;
+                continue;
+            }
+
+            if (last - p < 3 || hex_value(p[1]) == -1 || hex_value(p[2]) == -1)
+                return false;
+
+            filename += (char) (hex_value(p[1]) * 16 + hex_value(p[2]));
+            p += 2;
+        }
+
+        return true;
+    }
+
+    // next space-separated field of the line
+    bool next_field(const char*& p, const char* last, const char*& field_end) {
+
+        field_end = std::find(p, last, ' ');
+
+        return field_end != last && field_end != p;
+    }
+
+    /**
+     * unit_index_position
+     * @param tail the last bytes of the srcML
+     * @param size the size of tail
+     * @param position the offset of the unit index
+     *
+     * Find the position of the unit index from the trailer at the end of the srcML.
+     *
+     * @returns if the srcML ends with a unit index trailer.
+     */
+    bool unit_index_position(const char* tail, size_t size, unsigned long long& position) {
+
+        static const char trailer_end[] = "?>\n";
+        const size_t trailer_end_size = sizeof(trailer_end) - 1;
+
+        if (size <= trailer_end_size || memcmp(tail + size - trailer_end_size, trailer_end, trailer_end_size) != 0)
+            return false;
+
+        const char* last = tail + size - trailer_end_size;
+        const char* first = last;
+        while (first > tail && first[-1] >= '0' && first[-1] <= '9')
+            --first;
+
+        if (first == last || first == tail || first[-1] != '\n')
+            return false;
+
+        position = strtoull(std::string(first, last).c_str(), nullptr, 10);
+
+        return true;
+    }
+
+    /**
+     * unit_index_parse
+     * @param data the unit index
+     * @param size the size of data
+     * @param index the unit index entries
+     *
+     * Parse the unit index processing instruction.
+     *
+     * @returns if the unit index was valid.
+     */
+    bool unit_index_parse(const char* data, size_t size, std::vector<unit_index_entry>& index) {
+
+        const size_t header_size = sizeof(UNIT_INDEX_HEADER) - 1;
+        if (size < header_size || memcmp(data, UNIT_INDEX_HEADER, header_size) != 0)
+            return false;
+
+        index.clear();
+        const char* last = data + size;
+        for (const char* p = data + header_size; p < last; ) {
+
+            const char* eol = std::find(p, last, '\n');
+            if (eol == last)
+                break;
+
+            // the trailer is the last line of the index
+            if (eol - p >= 2 && eol[-2] == '?' && eol[-1] == '>')
+                return true;
+
+            unit_index_entry entry;
+            const char* field_end = nullptr;
+
+            if (!next_field(p, eol, field_end))
+                break;
+            entry.offset = strtoull(std::string(p, field_end).c_str(), nullptr, 10);
+            p = field_end + 1;
+
+            if (!next_field(p, eol, field_end))
+                break;
+            entry.length = strtoull(std::string(p, field_end).c_str(), nullptr, 10);
+            p = field_end + 1;
+
+            if (!next_field(p, eol, field_end))
+                break;
+            entry.loc = atoi(std::string(p, field_end).c_str());
+            p = field_end + 1;
+
+            if (!next_field(p, eol, field_end))
+                break;
+            if (field_end - p != 1 || *p != '-')
+                entry.language.assign(p, field_end);
+            p = field_end + 1;
+
+            if (!next_field(p, eol, field_end))
+                break;
+            if (field_end - p != 1 || *p != '-')
+                entry.hash.assign(p, field_end);
+            p = field_end + 1;
+
+            if (!unescape(p, eol, entry.filename))
+                break;
+
+            index.push_back(std::move(entry));
+
+            p = eol + 1;
+        }
+
+        index.clear();
+
+        return false;
+    }
+
+    /**
+     * unit_index_input
+     *
+     * Context for reading an archive starting at a unit.  The archive
+     * up to the first unit, i.e., the XML declaration and root start tag,
+     * is followed by the archive starting at the requested unit.
+     */
+    struct unit_index_input {
+
+        /** archive up to its first unit */
+        std::string prefix;
+
+        /** position in the prefix */
+        size_t prefix_pos = 0;
+
+        /** archive file, positioned at the requested unit */
+        FILE* file = nullptr;
+
+        /** archive memory, with the position of the requested unit */
+        const char* buffer = nullptr;
+        size_t size = 0;
+        size_t pos = 0;
+    };
+
+    int unit_index_read_callback(void* context, char* buffer, int len) {
+
+        auto input = (unit_index_input*) context;
+
+        if (input->prefix_pos < input->prefix.size()) {
+
+            size_t count = std::min((size_t) len, input->prefix.size() - input->prefix_pos);
+            memcpy(buffer, input->prefix.data() + input->prefix_pos, count);
+            input->prefix_pos += count;
+
+            return (int) count;
+        }
+
+        if (input->file)
+            return (int) fread(buffer, 1, len, input->file);
+
+        size_t count = std::min((size_t) len, input->size - input->pos);
+        memcpy(buffer, input->buffer + input->pos, count);
+        input->pos += count;
+
+        return (int) count;
+    }
+
+    int unit_index_close_callback(void* context) {
+
+        auto input = (unit_index_input*) context;
+
+        if (input->file)
+            fclose(input->file);
+
+        delete input;
+
+        return 0;
+    }
+
+    xmlParserInputBufferPtr unit_index_input_create(unit_index_input* input, xmlCharEncoding encoding) {
+
+        xmlParserInputBufferPtr buffer = xmlParserInputBufferCreateIO(unit_index_read_callback, unit_index_close_callback, input, encoding);
+        if (!buffer)
+            unit_index_close_callback(input);
+
+        return buffer;
+    }
+
+    // open only regular files, as other files cannot be reopened to seek
+    FILE* unit_index_open(const char* filename) {
+
+        struct stat info;
+        if (stat(filename, &info) != 0 || !S_ISREG(info.st_mode))
+            return nullptr;
+
+        return fopen(filename, "rb");
+    }
+}
+
+/**
+ * unit_index_format
+ * @param index the unit index entries
+ * @param position the offset in the output of the unit index
+ *
+ * Form the unit index processing instruction.
+ *
+ * @returns the unit index to append to the srcML.
+ */
+std::string unit_index_format(const std::vector<unit_index_entry>& index, unsigned long long position) {
+
+    std::string s(UNIT_INDEX_HEADER);
+    for (const auto& entry : index) {
+
+        s += std::to_string(entry.offset);
+        s += ' ';
+        s += std::to_string(entry.length);
+        s += ' ';
+        s += std::to_string(entry.loc);
+        s += ' ';
+        s += entry.language.empty() ? "-" : entry.language;
+        s += ' ';
+        s += entry.hash.empty() ? "-" : entry.hash;
+        s += ' ';
+        append_escaped(s, entry.filename);
+        s += '\n';
+    }
+
+    s += std::to_string(position);
+    s += "?>\n";
+
+    return s;
+}
+
+/**
+ * unit_index_read_filename
+ * @param filename name of a srcML file
+ * @param index the unit index entries
+ *
+ * Read the unit index from the end of the srcML file, without
+ * reading the rest of the file.
+ *
+ * @returns if the file has a valid unit index.
+ */
+bool unit_index_read_filename(const char* filename, std::vector<unit_index_entry>& index) {
+
+    FILE* file = unit_index_open(filename);
+    if (!file)
+        return false;
+
+    std::unique_ptr<FILE, int(*)(FILE*)> guard(file, fclose);
+
+    if (fseeko(file, 0, SEEK_END) != 0)
+        return false;
+
+    auto size = (unsigned long long) ftello(file);
+    auto tail_size = (size_t) std::min<unsigned long long>(size, UNIT_INDEX_TRAILER_SIZE);
+
+    char tail[UNIT_INDEX_TRAILER_SIZE];
+    if (fseeko(file, size - tail_size, SEEK_SET) != 0 || fread(tail, 1, tail_size, file) != tail_size)
+        return false;
+
+    unsigned long long position = 0;
+    if (!unit_index_position(tail, tail_size, position) || position >= size)
+        return false;
+
+    std::string data((size_t) (size - position), '\0');
+    if (fseeko(file, position, SEEK_SET) != 0 || fread(&data[0], 1, data.size(), file) != data.size())
+        return false;
+
+    return unit_index_parse(data.data(), data.size(), index);
+}
+
+/**
+ * unit_index_read_memory
+ * @param buffer srcML in memory
+ * @param size the size of buffer
+ * @param index the unit index entries
+ *
+ * Read the unit index from the end of the srcML in memory.
+ *
+ * @returns if the srcML has a valid unit index.
+ */
+bool unit_index_read_memory(const char* buffer, size_t size, std::vector<unit_index_entry>& index) {
+
+    size_t tail_size = std::min(size, UNIT_INDEX_TRAILER_SIZE);
+
+    unsigned long long position = 0;
+    if (!unit_index_position(buffer + size - tail_size, tail_size, position) || position >= size)
+        return false;
+
+    return unit_index_parse(buffer + position, size - (size_t) position, index);
+}
+
+/**
+ * unit_index_input_filename
+ * @param filename name of a srcML file
+ * @param first_offset offset of the first unit in the archive
+ * @param offset offset of the requested unit
+ * @param encoding the xml encoding of the file
+ *
+ * Create an input of the archive that starts at the requested unit,
+ * so that the requested unit is read as the first unit of the archive.
+ *
+ * @returns the input on success, and NULL on failure.
+ */
+xmlParserInputBufferPtr unit_index_input_filename(const char* filename, unsigned long long first_offset,
+                                                  unsigned long long offset, xmlCharEncoding encoding) {
+
+    FILE* file = unit_index_open(filename);
+    if (!file)
+        return nullptr;
+
+    auto input = new unit_index_input;
+    input->file = file;
+    input->prefix.resize((size_t) first_offset);
+
+    if (fread(&input->prefix[0], 1, input->prefix.size(), file) != input->prefix.size() || fseeko(file, offset, SEEK_SET) != 0) {
+        unit_index_close_callback(input);
+        return nullptr;
+    }
+
+    return unit_index_input_create(input, encoding);
+}
+
+/**
+ * unit_index_input_memory
+ * @param buffer srcML in memory
+ * @param size the size of buffer
+ * @param first_offset offset of the first unit in the archive
+ * @param offset offset of the requested unit
+ * @param encoding the xml encoding of the buffer
+ *
+ * Create an input of the archive that starts at the requested unit,
+ * so that the requested unit is read as the first unit of the archive.
+ *
+ * @returns the input on success, and NULL on failure.
+ */
+xmlParserInputBufferPtr unit_index_input_memory(const char* buffer, size_t size, unsigned long long first_offset,
+                                                unsigned long long offset, xmlCharEncoding encoding) {
+
+    if (first_offset > size || offset > size)
+        return nullptr;
+
+    auto input = new unit_index_input;
+    input->prefix.assign(buffer, (size_t) first_offset);
+    input->buffer = buffer;
+    input->size = size;
+    input->pos = (size_t) offset;
+
+    return unit_index_input_create(input, encoding);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file unit_index.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef INCLUDED_UNIT_INDEX_HPP
+#define INCLUDED_UNIT_INDEX_HPP
+
+#include <libxml/xmlIO.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * unit_index_entry
+ *
+ * Location and summary of a unit in a srcML archive, as
+ * recorded in the unit index that follows the root unit.
+ */
+struct unit_index_entry {
+
+    /** byte offset of the unit start tag */
+    unsigned long long offset = 0;
+
+    /** byte length of the unit, through the unit end tag */
+    unsigned long long length = 0;
+
+    /** loc of the unit source code */
+    int loc = -1;
+
+    /** unit language attribute */
+    std::string language;
+
+    /** unit hash attribute */
+    std::string hash;
+
+    /** unit filename attribute */
+    std::string filename;
+};
+
+// Form the unit index processing instruction, which starts at position in the output
+std::string unit_index_format(const std::vector<unit_index_entry>& index, unsigned long long position);
+
+// Read the unit index from the end of a srcML file
+bool unit_index_read_filename(const char* filename, std::vector<unit_index_entry>& index);
+
+// Read the unit index from the end of srcML in memory
+bool unit_index_read_memory(const char* buffer, size_t size, std::vector<unit_index_entry>& index);
+
+// Input of the archive up to its first unit, followed by the archive from offset on
+xmlParserInputBufferPtr unit_index_input_filename(const char* filename, unsigned long long first_offset,
+                                                  unsigned long long offset, xmlCharEncoding encoding);
+xmlParserInputBufferPtr unit_index_input_memory(const char* buffer, size_t size, unsigned long long first_offset,
+                                                unsigned long long offset, xmlCharEncoding encoding);
+
+#endif
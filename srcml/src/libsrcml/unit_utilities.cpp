@@ -23,6 +23,11 @@
 #include <unit_utilities.hpp>
 #include <libxml/parserInternals.h>
 #include <stack>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+#include <utility>
 
 // Update unit attributes with xml parsed attributes
 void unit_update_attributes(srcml_unit* unit, int num_attributes, const xmlChar** attributes) {
@@ -120,6 +125,263 @@ std::string extract_revision(const char* srcml, int size, int revision, bool tex
     return news;
 }
 
+namespace {
+
+    // attribute of a start tag, as found by next_attribute()
+    struct tag_attribute {
+        const char* name = nullptr;
+        size_t name_size = 0;
+        const char* value = nullptr;
+        size_t value_size = 0;
+    };
+
+    // next attribute in the start tag from p to the end of the tag, or nullptr when no more
+    const char* next_attribute(const char* p, const char* end, tag_attribute& attribute) {
+
+        while (p < end && isspace((unsigned char) *p))
+            ++p;
+
+        attribute.name = p;
+        while (p < end && *p != '=' && !isspace((unsigned char) *p) && *p != '/' && *p != '>')
+            ++p;
+        attribute.name_size = p - attribute.name;
+        if (attribute.name_size == 0)
+            return nullptr;
+
+        while (p < end && isspace((unsigned char) *p))
+            ++p;
+        if (p == end || *p != '=')
+            return nullptr;
+        ++p;
+        while (p < end && isspace((unsigned char) *p))
+            ++p;
+        if (p == end || (*p != '"' && *p != '\''))
+            return nullptr;
+
+        const char* close = (const char*) memchr(p + 1, *p, end - (p + 1));
+        if (!close)
+            return nullptr;
+
+        attribute.value = p + 1;
+        attribute.value_size = close - attribute.value;
+
+        return close + 1;
+    }
+
+    // append the UTF-8 encoding of the code point c
+    void append_utf8(std::string& s, unsigned long c) {
+
+        if (c < 0x80) {
+            s += (char) c;
+        } else if (c < 0x800) {
+            s += (char) (0xC0 | (c >> 6));
+            s += (char) (0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            s += (char) (0xE0 | (c >> 12));
+            s += (char) (0x80 | ((c >> 6) & 0x3F));
+            s += (char) (0x80 | (c & 0x3F));
+        } else {
+            s += (char) (0xF0 | (c >> 18));
+            s += (char) (0x80 | ((c >> 12) & 0x3F));
+            s += (char) (0x80 | ((c >> 6) & 0x3F));
+            s += (char) (0x80 | (c & 0x3F));
+        }
+    }
+
+    // decode the entity or character reference starting at p, returning the position after it,
+    // or nullptr if it is not one that can be decoded without a parser
+    const char* decode_reference(const char* p, const char* end, std::string& s) {
+
+        const char* semicolon = (const char*) memchr(p, ';', std::min<size_t>(end - p, 12));
+        if (!semicolon)
+            return nullptr;
+
+        std::string name(p + 1, semicolon);
+        if (name == "lt")
+            s += '<';
+        else if (name == "gt")
+            s += '>';
+        else if (name == "amp")
+            s += '&';
+        else if (name == "quot")
+            s += '"';
+        else if (name == "apos")
+            s += '\'';
+        else if (name.size() > 1 && name[0] == '#') {
+
+            bool hex = name[1] == 'x';
+            const char* digits = name.c_str() + (hex ? 2 : 1);
+            if (*digits == '\0')
+                return nullptr;
+
+            char* digits_end = nullptr;
+            unsigned long c = strtoul(digits, &digits_end, hex ? 16 : 10);
+            if (*digits_end != '\0' || c == 0 || c > 0x10FFFF)
+                return nullptr;
+
+            append_utf8(s, c);
+        } else {
+            return nullptr;
+        }
+
+        return semicolon + 1;
+    }
+
+    /*
+     * Extract the source code from srcML written by the srcML writer, scanning the bytes
+     * directly instead of parsing. The writer produces a limited subset of XML, so anything
+     * outside of it, e.g., comments, CDATA, processing instructions, carriage returns, or
+     * namespace declarations on inner elements, returns false so that a full parse is done.
+     */
+    bool extract_src_scan(const std::string& srcml, std::string& src) {
+
+        const char* p = srcml.c_str();
+        const char* end = p + srcml.size();
+
+        // prefix of the src:escape element, with the namespace declared in the start tag of the unit
+        std::string escape_name;
+        bool have_escape_name = false;
+
+        src.reserve(srcml.size() / 2);
+
+        // names of the open elements, to check that end tags match
+        std::vector<std::pair<const char*, size_t>> open_elements;
+
+        int depth = 0;
+        while (p < end) {
+
+            // text up to the next tag
+            const char* lt = (const char*) memchr(p, '<', end - p);
+            if (!lt)
+                return false;
+
+            if (depth == 0) {
+                // only whitespace can occur outside of the unit
+                for (; p < lt; ++p)
+                    if (!isspace((unsigned char) *p))
+                        return false;
+            }
+
+            if (memchr(p, '\r', lt - p))
+                return false;
+
+            while (const char* amp = (const char*) memchr(p, '&', lt - p)) {
+
+                src.append(p, amp - p);
+
+                p = decode_reference(amp, lt, src);
+                if (!p)
+                    return false;
+            }
+            src.append(p, lt - p);
+
+            // comments, CDATA, DOCTYPE, and processing instructions
+            if (lt + 1 == end || lt[1] == '!' || lt[1] == '?')
+                return false;
+
+            // end of the tag, skipping over any '>' in attribute values
+            const char* gt = lt + 1;
+            while (true) {
+                const char* next_gt = (const char*) memchr(gt, '>', end - gt);
+                if (!next_gt)
+                    return false;
+
+                const char* quote = std::find_if(gt, next_gt, [](char c) { return c == '"' || c == '\''; });
+                if (quote == next_gt) {
+                    gt = next_gt;
+                    break;
+                }
+
+                const char* close = (const char*) memchr(quote + 1, *quote, end - (quote + 1));
+                if (!close)
+                    return false;
+                gt = close + 1;
+            }
+            p = gt + 1;
+
+            // end tag
+            if (lt[1] == '/') {
+                if (--depth < 0)
+                    return false;
+
+                const char* end_name = lt + 2;
+                size_t end_name_size = gt - end_name;
+                while (end_name_size > 0 && isspace((unsigned char) end_name[end_name_size - 1]))
+                    --end_name_size;
+                if (open_elements.back().second != end_name_size || strncmp(open_elements.back().first, end_name, end_name_size) != 0)
+                    return false;
+                open_elements.pop_back();
+
+                if (depth == 0)
+                    break;
+                continue;
+            }
+
+            bool empty = gt[-1] == '/';
+            const char* tag_end = empty ? gt - 1 : gt;
+
+            const char* name_end = lt + 1;
+            while (name_end < tag_end && !isspace((unsigned char) *name_end))
+                ++name_end;
+
+            // unit start tag, with the namespace declarations
+            if (depth == 0 && !have_escape_name) {
+
+                tag_attribute attribute;
+                for (const char* ap = name_end; (ap = next_attribute(ap, tag_end, attribute)); ) {
+
+                    if (attribute.value_size != strlen(SRCML_SRC_NS_URI) || strncmp(attribute.value, SRCML_SRC_NS_URI, attribute.value_size) != 0)
+                        continue;
+
+                    std::string name(attribute.name, attribute.name_size);
+                    if (name == "xmlns") {
+                        escape_name = "escape";
+                        have_escape_name = true;
+                    } else if (name.compare(0, 6, "xmlns:") == 0) {
+                        escape_name = name.substr(6) + ":escape";
+                        have_escape_name = true;
+                    }
+                }
+
+                if (!have_escape_name)
+                    return false;
+
+            } else if (std::search(name_end, tag_end, "xmlns", "xmlns" + 5) != tag_end) {
+                return false;
+            }
+
+            // src:escape element for a character that cannot be in XML
+            if (depth > 0 && escape_name.compare(0, std::string::npos, lt + 1, name_end - (lt + 1)) == 0) {
+
+                tag_attribute attribute;
+                const char* ap = next_attribute(name_end, tag_end, attribute);
+                if (!ap || std::string(attribute.name, attribute.name_size) != "char")
+                    return false;
+
+                std::string svalue(attribute.value, attribute.value_size);
+                src.append(1, (char) strtol(svalue.c_str(), NULL, 0));
+            }
+
+            if (empty) {
+                if (depth == 0)
+                    break;
+            } else {
+                ++depth;
+                open_elements.emplace_back(lt + 1, name_end - (lt + 1));
+            }
+        }
+
+        // anything but trailing whitespace, or an incomplete unit
+        if (depth != 0)
+            return false;
+        for (; p < end; ++p)
+            if (!isspace((unsigned char) *p))
+                return false;
+
+        return true;
+    }
+}
+
 struct extract_context {
     std::string s;
     boost::optional<int> revision;
@@ -129,6 +391,11 @@ struct extract_context {
 // Extract source code from srcml
 std::string extract_src(const std::string& srcml, boost::optional<int> revision) {
 
+    // most srcML is from the srcML writer, and does not need a full parse
+    std::string src;
+    if (extract_src_scan(srcml, src))
+        return src;
+
     extract_context scontext;
     scontext.revision = revision;
     scontext.mode.push(COMMON);
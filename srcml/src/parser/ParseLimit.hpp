@@ -0,0 +1,104 @@
+/**
+ * @file ParseLimit.hpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * This file is part of the srcML Toolkit.
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef PARSE_LIMIT_HPP
+#define PARSE_LIMIT_HPP
+
+#include <chrono>
+#include <string>
+
+/**
+ * ParseLimit
+ *
+ * Time and input size limits on the parse of a single unit. Input of a known
+ * size over the size limit is not parsed at all. Otherwise, the limits are
+ * checked cooperatively, when the parser asks for a token and before it guesses.
+ * Once a limit is exceeded the input ends for the parser, and the unit is formed
+ * from the text of the input instead.
+ */
+class ParseLimit {
+public:
+
+    /**
+     * ParseLimit
+     * @param time_limit maximum time of the parse in milliseconds, 0 for none
+     * @param size_limit maximum size of the input in bytes, 0 for none
+     *
+     * Constructor.  The time limit starts now.
+     */
+    ParseLimit(unsigned int time_limit, size_t size_limit)
+        : time_limit(time_limit), size_limit(size_limit),
+          deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(time_limit)) {}
+
+    /**
+     * exceeded
+     *
+     * Check the time limit. Once exceeded, stays exceeded.
+     *
+     * @returns if a limit was exceeded
+     */
+    bool exceeded() {
+
+        if (reason)
+            return true;
+
+        if (time_limit && std::chrono::steady_clock::now() >= deadline)
+            reason = "timeout";
+
+        return reason != nullptr;
+    }
+
+    /**
+     * exceeded
+     * @param size size in bytes of the input, or of the input read so far
+     *
+     * Check the size and time limits. Once exceeded, stays exceeded.
+     *
+     * @returns if a limit was exceeded
+     */
+    bool exceeded(size_t size) {
+
+        if (!reason && size_limit && size > size_limit)
+            reason = "size";
+
+        return exceeded();
+    }
+
+    /**
+     * getReason
+     *
+     * @returns the limit that was exceeded, "timeout" or "size", or 0 if none was
+     */
+    const char* getReason() const { return reason; }
+
+    /** text of the input kept by the UTF8CharBuffer, only for input that cannot be read again */
+    bool keep_text = false;
+    std::string text;
+
+private:
+    unsigned int time_limit;
+    size_t size_limit;
+    std::chrono::steady_clock::time_point deadline;
+    const char* reason = nullptr;
+};
+
+#endif
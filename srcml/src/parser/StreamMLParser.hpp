@@ -212,6 +212,7 @@ private:
         ntoken->setColumn(LT(1)->getColumn());
 
         if (isoption(options, SRCML_OPTION_POSITION)) {
+            static_cast<srcMLToken*>(&(*ntoken))->endpending = true;
             ends.emplace(ntoken);
         }
 
@@ -226,6 +227,7 @@ private:
         ntoken->setColumn(LT(1)->getColumn());
 
         if (isoption(options, SRCML_OPTION_POSITION)) {
+            static_cast<srcMLToken*>(&(*ntoken))->endpending = true;
             ends.emplace(ntoken);
         }
 
@@ -252,6 +254,7 @@ private:
         }
 
         if (isoption(options, SRCML_OPTION_POSITION)) {
+            static_cast<srcMLToken*>(&(*ntoken))->endpending = true;
             ends.emplace(ntoken);
         }
 
@@ -277,6 +280,7 @@ private:
 
             qetoken->endline = lastline;
             qetoken->endcolumn = lastcolumn;
+            qetoken->endpending = false;
 
             if (token == srcMLParser::STYPE) {
                 lasttypeendline = lastline;
@@ -303,6 +307,7 @@ private:
             srcMLToken* qetoken = static_cast<srcMLToken*>(&(*std::move(ends.top())));
             qetoken->endline = slastline;
             qetoken->endcolumn = slastcolumn;
+            qetoken->endpending = false;
             ends.pop();
         }
      }
@@ -674,20 +679,8 @@ private:
         while (paused)
             fillTokenBuffer();
 
-        // to calculate end position, need to buffer until end token in reached
-        // to prevent infinite loops, consume is called if no progress is made on the
-        // current token, e.g., double max const();
-        if (isoption(options, SRCML_OPTION_POSITION)) {
-            auto curline = LT(1)->getLine();
-            auto curcolumn = LT(1)->getColumn();
-            while (ends.size() > 1) {
-                fillTokenBuffer();
-                if (LT(1)->getLine() == curline && LT(1)->getColumn() == curcolumn)
-                    consume();
-                curline = LT(1)->getLine();
-                curcolumn = LT(1)->getColumn();
-            }
-        }
+        // with position output, a start token whose end is not known yet is output anyway,
+        // and srcMLOutput inserts its position attributes once the end is known
 
         // pop and send back the top token
         const antlr::RefToken& tok = std::move(tb.front());
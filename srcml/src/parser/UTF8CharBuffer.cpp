@@ -23,7 +23,9 @@
 #include <UTF8CharBuffer.hpp>
 
 #include <sha1utilities.hpp>
+#include <srcml_statistics.hpp>
 #include <iostream>
+#include <algorithm>
 #include <fcntl.h>
 #include <iterator>
 #include <map>
@@ -184,7 +186,9 @@ UTF8CharBuffer::UTF8CharBuffer(const char* c_buffer, size_t buffer_size, const c
     insize = raw.size();
 
     // since we already have all the data, need to hash and perform encoding
+    SRCML_STATISTICS(srcml_statistics_timer timer(SRCML_STAGE_INPUT);)
     insize = readChars();
+    SRCML_STATISTICS(timer.set_amount(insize);)
 }
 
 /**
@@ -409,6 +413,69 @@ ssize_t UTF8CharBuffer::readChars() {
     return trivial ? raw.size() : cooked.size();
 }
 
+/**
+ * append_text
+ * @param text the text to append to
+ * @param first start of the characters
+ * @param last end of the characters
+ * @param lastcr if the character before first was a carriage return, updated for the character before last
+ *
+ * Append the characters as a whole, with the same end of line
+ * conversion as getChar().
+ */
+static void append_text(std::string& text, const char* first, const char* last, bool& lastcr) {
+
+    if (first == last)
+        return;
+
+    // sequence "\r\n" split between buffers
+    if (lastcr && *first == '\n')
+        ++first;
+    lastcr = false;
+
+    while (first != last) {
+
+        const char* cr = std::find(first, last, '\r');
+        text.append(first, cr);
+        if (cr == last)
+            break;
+
+        // convert carriage returns to a line feed
+        text += '\n';
+        first = cr + 1;
+        if (first == last)
+            lastcr = true;
+        else if (*first == '\n')
+            ++first;
+    }
+}
+
+/**
+ * loadChars
+ *
+ * Read the next buffer of characters, and keep a copy of them if needed.
+ *
+ * @returns if there are more characters
+ */
+bool UTF8CharBuffer::loadChars() {
+
+    SRCML_STATISTICS(srcml_statistics_timer timer(SRCML_STAGE_INPUT);)
+    insize = readChars();
+    SRCML_STATISTICS(timer.set_amount(insize);)
+    if (insize == 0) {
+        // EOF
+        return false;
+    }
+    size += insize;
+
+    if (kept) {
+        const char* data = (trivial ? raw : cooked).data();
+        append_text(*kept, data + pos, data + insize, keptcr);
+    }
+
+    return true;
+}
+
 /**
  * getChar
  *
@@ -428,14 +495,8 @@ int UTF8CharBuffer::getChar() {
     unsigned char c = 0;
 
     // may need more characters
-    if (insize == 0 || pos >= insize) {
-
-        insize = readChars();
-        if (insize == 0) {
-            // EOF
-            return -1;
-        }
-    }
+    if ((insize == 0 || pos >= insize) && !loadChars())
+        return -1;
 
     // read the next char either from the current input buffer (for a trivial, no-iconv needed)
     // or from the iconv'ed output buffer
@@ -464,6 +525,52 @@ int UTF8CharBuffer::getChar() {
     return c;
 }
 
+/**
+ * readText
+ * @param text where to append the rest of the input, or 0 to only read it
+ *
+ * Read the rest of the input a buffer at a time instead of by getChar(),
+ * e.g., for the hash, or for the text of a unit that is not parsed.
+ */
+void UTF8CharBuffer::readText(std::string* text) {
+
+    std::string discard;
+    std::string& out = text ? *text : discard;
+
+    while ((insize != 0 && pos < insize) || loadChars()) {
+
+        const char* data = (trivial ? raw : cooked).data();
+        size_t start = out.size();
+        append_text(out, data + pos, data + insize, lastcr);
+        pos = insize;
+
+        if (out.size() > start) {
+            loc += (int) std::count(out.begin() + start, out.end(), '\n');
+            lastchar = (unsigned char) out.back();
+        }
+
+        if (!text)
+            discard.clear();
+    }
+}
+
+/**
+ * keepText
+ * @param text where to keep a copy of the characters, or 0 to stop keeping them
+ *
+ * Keep a copy of the characters of the stream from the current position on.
+ * The copy is made a buffer at a time, so it may be ahead of getChar().
+ */
+void UTF8CharBuffer::keepText(std::string* text) {
+
+    kept = text;
+    keptcr = lastcr;
+    if (kept && insize != 0 && pos < insize) {
+        const char* data = (trivial ? raw : cooked).data();
+        append_text(*kept, data + pos, data + insize, keptcr);
+    }
+}
+
 /**
  * getEncoding
  *
@@ -124,6 +124,15 @@ public:
 
     int getLOC() { if (lastchar == '\n') return loc; else return loc + 1; }
 
+    // Size in bytes of the UTF-8 input read so far
+    size_t getSize() const { return size; }
+
+    // Read the rest of the stream in bulk
+    void readText(std::string* text);
+
+    // Keep a copy of the characters from the stream
+    void keepText(std::string* text);
+
     ~UTF8CharBuffer();
 
 private:
@@ -131,6 +140,8 @@ private:
 
     ssize_t readChars();
 
+    bool loadChars();
+
     /* position currently at in input buffer */
     size_t pos = 0;
 
@@ -184,5 +195,14 @@ private:
 
     /** first time reading data */
     bool firstRead = true;
+
+    /** bytes of UTF-8 read so far */
+    size_t size = 0;
+
+    /** where to keep a copy of the characters, if anywhere */
+    std::string* kept = nullptr;
+
+    /** if the last kept character was a carriage return */
+    bool keptcr = false;
 };
 #endif
@@ -29,6 +29,8 @@
 #include "srcmlns.hpp"
 #include <srcml.h>
 
+#include <cstring>
+
 // Definition of elements, including name, URI, attributes, and special processing
 // Included to take advantage of inlined methods
 #include <srcMLOutputElements.hpp>
@@ -62,6 +64,49 @@ namespace {
         // end of string that we are using
         return p;
     }
+
+    /**
+     * writePosition
+     * @param stoken token with start and end positions
+     * @param start start of the start attribute, e.g., ' pos:start="'
+     * @param end start of the end attribute, e.g., ' pos:end="'
+     * @param write writes a string with a length
+     *
+     * Write the position attributes, e.g., pos:start="1:4" pos:end="2:1"
+     */
+    template <typename Write>
+    inline void writePosition(const srcMLToken* stoken, const std::string& start, const std::string& end, Write write) {
+
+        // position start attribute, e.g. pos:start="1:4"
+        write(start.c_str(), (int) start.size());
+        const char* s = positoa(stoken->getLine());
+        write(s, (int) strlen(s));
+        write(":", 1);
+        s = positoa(stoken->getColumn());
+        write(s, (int) strlen(s));
+        write("\"", 1);
+
+        // position end attribute, e.g. pos:end="2:1"
+        write(end.c_str(), (int) end.size());
+        if (stoken->getLine() > stoken->endline) {
+            write("INVALID_POS(", 12);
+        }
+        s = positoa(stoken->endline);
+        write(s, (int) strlen(s));
+        if (stoken->getLine() > stoken->endline) {
+            write(")", 1);
+        }
+        write(":", 1);
+        s = positoa(stoken->endcolumn);
+        write(s, (int) strlen(s));
+        write("\"", 1);
+    }
+
+    /** how we detect empty elements: the position is wrong */
+    inline bool emptyPosition(const srcMLToken* stoken) {
+
+        return stoken->endline < stoken->getLine() || (stoken->endline == stoken->getLine() && stoken->endcolumn < stoken->getColumn());
+    }
 }
 
 /**
@@ -106,6 +151,25 @@ void srcMLOutput::initNamespaces(const Namespaces& otherns) {
     namespaces += otherns;
 }
 
+/**
+ * setNamespaces
+ * @param merged namespaces already merged with the default
+ *
+ * Set the output namespaces to the result of a previous initNamespaces().
+ * When the prefixes and URIs are the same as the current ones, only
+ * the flags are copied, so there is no allocation.
+ */
+void srcMLOutput::setNamespaces(const Namespaces& merged) {
+
+    if (!equal_namespaces(namespaces, merged, false)) {
+        namespaces = merged;
+        return;
+    }
+
+    for (Namespaces::size_type i = 0; i < namespaces.size(); ++i)
+        namespaces[i].flags = merged[i].flags;
+}
+
 /**
  * ~srcMLOutput
  *
@@ -409,7 +473,7 @@ void srcMLOutput::startUnit(const char* language, const char* revision,
  *
  * Set the macro list to use for output.
  */
-void srcMLOutput::setMacroList(std::vector<std::string> & list) {
+void srcMLOutput::setMacroList(const std::vector<std::string>& list) {
 
     user_macro_list = list;
 }
@@ -497,35 +561,66 @@ void srcMLOutput::addPosition(const antlr::RefToken& token) {
 
     srcMLToken* stoken = static_cast<srcMLToken*>(&(*token));
 
-    // how we detect empty elements: the position is wrong
-    if (stoken->endline < stoken->getLine() || (stoken->endline == stoken->getLine() && stoken->endcolumn < stoken->getColumn()))
-            return;
+    if (position_start.empty()) {
+        const std::string& prefix = namespaces[POS].prefix;
+        position_start = " " + prefix + (!prefix.empty() ? ":" : "") + "start=\"";
+        position_end   = " " + prefix + (!prefix.empty() ? ":" : "") + "end=\"";
+    }
+
+    // the end of the element is not parsed yet, so the attributes are inserted
+    // into the output when the unit is finished, instead of holding the output
+    if (stoken->endpending) {
+        open_positions.back() = (int) deferred_positions.size();
+        deferred_positions.push_back({ outputOffset(), token, std::string() });
+        return;
+    }
 
-    thread_local const std::string& prefix = namespaces[POS].prefix;
-    thread_local const std::string startAttribute = " " + prefix + (!prefix.empty() ? ":" : "") + "start=\"";
-    thread_local const std::string endAttribute   = " " + prefix + (!prefix.empty() ? ":" : "") + "end=\"";
+    if (emptyPosition(stoken))
+        return;
 
     // highly optimized as this is output for every start tag
+    writePosition(stoken, position_start, position_end, [this](const char* s, int size) {
+        xmlOutputBufferWrite(output_buffer, size, s);
+    });
+}
 
-    // position start attribute, e.g. pos:start="1:4"
-    xmlOutputBufferWrite(output_buffer, (int) startAttribute.size(), startAttribute.c_str());
-    xmlOutputBufferWriteString(output_buffer, positoa(token->getLine()));
-    xmlOutputBufferWrite(output_buffer, 1, ":");
-    xmlOutputBufferWriteString(output_buffer, positoa(token->getColumn()));
-    xmlOutputBufferWrite(output_buffer, 1, "\"");
-
-    // position end attribute, e.g. pos:end="2:1"
-    xmlOutputBufferWrite(output_buffer, (int) endAttribute.size(), endAttribute.c_str());
-    if (token->getLine() > stoken->endline) {
-        xmlOutputBufferWriteString(output_buffer, "INVALID_POS(");
-    }
-    xmlOutputBufferWriteString(output_buffer, positoa(stoken->endline));
-    if (token->getLine() > stoken->endline) {
-        xmlOutputBufferWriteString(output_buffer, ")");
+/**
+ * resolvePosition
+ * @param deferred the deferred position of an element that ended
+ *
+ * Form the position attributes of an element whose start tag was output
+ * before its end position was known.
+ */
+void srcMLOutput::resolvePosition(deferred_position& deferred) {
+
+    srcMLToken* stoken = static_cast<srcMLToken*>(&(*deferred.token));
+
+    if (!emptyPosition(stoken)) {
+
+        writePosition(stoken, position_start, position_end, [&deferred](const char* s, int size) {
+            deferred.attributes.append(s, size);
+        });
     }
-    xmlOutputBufferWrite(output_buffer, 1, ":");
-    xmlOutputBufferWriteString(output_buffer, positoa(stoken->endcolumn));
-    xmlOutputBufferWrite(output_buffer, 1, "\"");
+
+    // the token is no longer needed
+    deferred.token = antlr::RefToken();
+}
+
+/**
+ * outputOffset
+ *
+ * Offset in the output of the next write. Unit output is UTF-8, so
+ * output that is not converted yet has the same size once converted.
+ *
+ * @returns the offset
+ */
+int srcMLOutput::outputOffset() const {
+
+    int offset = output_buffer->written + (int) xmlBufUse(output_buffer->buffer);
+    if (output_buffer->conv)
+        offset += (int) xmlBufUse(output_buffer->conv);
+
+    return offset;
 }
 
 void srcMLOutput::processToken(const antlr::RefToken& token, const char* name, const char* prefix, const char* attr_name1, const char* attr_value1,
@@ -553,12 +648,22 @@ void srcMLOutput::processToken(const antlr::RefToken& token, const char* name, c
             xmlTextWriterWriteAttribute(xout, BAD_CAST attr_name2, BAD_CAST attr_value2);
 
         // if position attributes for non-empty start elements
-        if (isposition && !isempty(token))
+        if (isposition && !isempty(token)) {
+            open_positions.push_back(-1);
             addPosition(token);
+        }
     }
 
     if (!isstart(token) || isempty(token)) {
 
+        // the end position of the element is now known
+        if (isposition && !isempty(token) && !open_positions.empty()) {
+            int deferred = open_positions.back();
+            open_positions.pop_back();
+            if (deferred != -1)
+                resolvePosition(deferred_positions[deferred]);
+        }
+
         --openelementcount;
         xmlTextWriterEndElement(xout);
     }
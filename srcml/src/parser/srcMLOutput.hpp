@@ -35,6 +35,7 @@
 #include "srcMLException.hpp"
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "srcmlns.hpp"
 #include <libxml/xmlwriter.h>
 
@@ -79,6 +80,8 @@ public:
 
     void initNamespaces(const Namespaces& namespaces);
 
+    void setNamespaces(const Namespaces& namespaces);
+
      /**
      * getWriter
      *
@@ -99,6 +102,31 @@ public:
 
     const Namespaces& getNamespaces() const { return namespaces; }
 
+    /**
+     * deferred_position
+     *
+     * Position attributes of a start tag that was output before the end
+     * position of its element was known.
+     */
+    struct deferred_position {
+
+        /** offset in the output where the attributes belong */
+        int offset;
+
+        /** the start token, until the end of its element */
+        antlr::RefToken token;
+
+        /** the position attributes, once the end is known */
+        std::string attributes;
+    };
+
+    /**
+     * getDeferredPositions
+     *
+     * Position attributes to insert into the output, in order of offset.
+     */
+    std::vector<deferred_position>& getDeferredPositions() { return deferred_positions; }
+
     // start a unit element with the passed metadata
     void startUnit(const char* unit_language, const char* revision,
                    const char* unit_url, const char* unit_filename,
@@ -127,6 +155,22 @@ private:
     // adds the position attributes to a token
     void addPosition(const antlr::RefToken& token);
 
+    // forms the deferred position attributes of an element that ended
+    void resolvePosition(deferred_position& deferred);
+
+    // offset in the output of the next write
+    int outputOffset() const;
+
+    /** position attribute starts, e.g., ' pos:start="' */
+    std::string position_start;
+    std::string position_end;
+
+    /** position attributes inserted after the output */
+    std::vector<deferred_position> deferred_positions;
+
+    /** index of the deferred position of each open element, or -1 */
+    std::vector<int> open_positions;
+
 public:
     /** token stream input */
     TokenStream* input = nullptr;
@@ -190,7 +234,7 @@ public:
 
     void outputNamespaces(xmlTextWriterPtr xout, const OPTION_TYPE& options, int depth);
 
-    void setMacroList(std::vector<std::string> & list);
+    void setMacroList(const std::vector<std::string>& list);
 
     void outputMacroList();
 
@@ -134,6 +134,7 @@ header "post_include_hpp" {
 #include <stack>
 #include "Language.hpp"
 #include "ModeStack.hpp"
+#include "ParseLimit.hpp"
 #include <srcml_types.hpp>
 #include <srcml_macros.hpp>
 #include <srcml.h>
@@ -727,6 +728,7 @@ public:
     std::vector<std::pair<srcMLState::MODE_TYPE, std::stack<int> > > finish_elements_add;
     bool in_template_param = false;
     int start_count = 0;
+    ParseLimit* parse_limit = nullptr;
 
     static const antlr::BitSet keyword_name_token_set;
     static const antlr::BitSet keyword_token_set;
@@ -786,6 +788,13 @@ public:
 
     }
 
+    // rewinds of guesses, including the syntactic predicates
+    void rewind(unsigned int pos) {
+
+        SRCML_STATISTICS_EVENT(SRCML_STAGE_REWIND, 0);
+        LLkParser::rewind(pos);
+    }
+
 }
 
 
@@ -4089,6 +4098,16 @@ condition_inner[] { ENTRY_DEBUG
 // perform an arbitrary look ahead looking for a pattern
 pattern_check[STMT_TYPE& type, int& token, int& type_count, int& after_token, bool inparam = false] returns [bool isdecl] {
 
+    SRCML_STATISTICS(srcml_statistics_nested_timer guess_timer(SRCML_STAGE_GUESS);)
+
+    // over the limits of the parse, so no more guessing as the input is ending
+    if (parse_limit && parse_limit->exceeded()) {
+
+        type = NONE;
+        type_count = 0;
+        return false;
+    }
+
     isdecl = true;
 
     int specifier_count;
@@ -151,6 +151,9 @@ public:
     int endline = 0;
     int endcolumn = 0;
 
+    /** the end position is not known yet */
+    bool endpending = false;
+
     /** the tokens text */
     std::string text;
 };
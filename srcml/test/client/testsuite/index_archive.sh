@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test archive with a unit index
+define srcml <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION">
+
+	<unit revision="REVISION" language="C++" filename="sub/a.cpp" hash="a301d91aac4aa1ab4e69cbc59cde4b4fff32f2b8"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit>
+
+	<unit revision="REVISION" language="C++" filename="sub/b.cpp" hash="9a1e1d3d0e27715d29bcfbf72b891b3ece985b36"><expr_stmt><expr><name>b</name></expr>;</expr_stmt></unit>
+
+	</unit>
+	<?srcml-index offset length loc language hash filename
+	120 165 1 C++ a301d91aac4aa1ab4e69cbc59cde4b4fff32f2b8 sub/a.cpp
+	287 165 1 C++ 9a1e1d3d0e27715d29bcfbf72b891b3ece985b36 sub/b.cpp
+	462?>
+	STDOUT
+
+define count_output <<- 'STDOUT'
+	2
+	STDOUT
+
+xmlcheck "$srcml"
+createfile sub/a.cpp "a;"
+createfile sub/b.cpp "b;"
+
+srcml sub/a.cpp sub/b.cpp --index
+check "$srcml"
+
+srcml --index sub/a.cpp sub/b.cpp
+check "$srcml"
+
+srcml sub/a.cpp sub/b.cpp --index -o sub/index.xml
+check sub/index.xml "$srcml"
+
+# units are located using the index
+srcml --unit 2 sub/index.xml
+check "b;"
+
+srcml --unit 1 sub/index.xml
+check "a;"
+
+srcml --show-unit-count sub/index.xml
+check "$count_output"
+
+# without random access, the units are still read in order
+srcml --unit 2 < sub/index.xml
+check "b;"
+
+srcml --show-unit-count < sub/index.xml
+check "$count_output"
+
+# no index for a solitary unit
+define srcml_unit <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="sub/a.cpp"><expr_stmt><expr><name>a</name></expr>;</expr_stmt></unit>
+	STDOUT
+
+srcml sub/a.cpp --index
+check "$srcml_unit"
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test on compressed files with .bz2 extension made of concatenated streams
+define src <<- 'STDOUT'
+
+	a;
+	STDOUT
+
+define src2 <<- 'STDOUT'
+	b;
+	STDOUT
+
+createfile archive/a.cpp "$src"
+createfile archive/b.cpp "$src2"
+
+# small file of two streams
+cat archive/a.cpp archive/b.cpp > archive/ab.cpp
+bzip2 -c archive/a.cpp > archive/ab.cpp.bz2
+bzip2 -c archive/b.cpp >> archive/ab.cpp.bz2
+
+srcml archive/ab.cpp -o archive/ab.xml
+srcml archive/ab.cpp.bz2 -o archive/ab.cpp.xml
+check_file archive/ab.cpp.xml archive/ab.xml
+
+# file of many streams, larger than a piece decompressed in parallel
+head -c 4000000 /dev/urandom | od -An -v -tx4 | sed 's/^ */x/; s/ /+x/g; s/$/;/' > archive/big.cpp
+split -b 1048576 archive/big.cpp archive/big.part.
+for part in archive/big.part.*; do bzip2 -c $part; done > archive/big.cpp.bz2
+
+srcml archive/big.cpp -o archive/big.xml
+srcml archive/big.cpp.bz2 -o archive/big.cpp.xml
+check_file archive/big.cpp.xml archive/big.xml
+
+srcml archive/big.xml -o archive/big.out.cpp
+check_file archive/big.out.cpp archive/big.cpp
+
+rm -f archive/big.part.*
+rmfile archive/a.cpp
+rmfile archive/b.cpp
+rmfile archive/ab.cpp
+rmfile archive/ab.cpp.bz2
+rmfile archive/ab.xml
+rmfile archive/ab.cpp.xml
+rmfile archive/big.cpp
+rmfile archive/big.cpp.bz2
+rmfile archive/big.xml
+rmfile archive/big.cpp.xml
+rmfile archive/big.out.cpp
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test on compressed files with .gz extension made of concatenated streams
+define src <<- 'STDOUT'
+
+	a;
+	STDOUT
+
+define src2 <<- 'STDOUT'
+	b;
+	STDOUT
+
+createfile archive/a.cpp "$src"
+createfile archive/b.cpp "$src2"
+
+# small file of two streams
+cat archive/a.cpp archive/b.cpp > archive/ab.cpp
+gzip -c archive/a.cpp > archive/ab.cpp.gz
+gzip -c archive/b.cpp >> archive/ab.cpp.gz
+
+srcml archive/ab.cpp -o archive/ab.xml
+srcml archive/ab.cpp.gz -o archive/ab.cpp.xml
+check_file archive/ab.cpp.xml archive/ab.xml
+
+# file of many streams, larger than a piece decompressed in parallel
+head -c 4000000 /dev/urandom | od -An -v -tx4 | sed 's/^ */x/; s/ /+x/g; s/$/;/' > archive/big.cpp
+split -b 1048576 archive/big.cpp archive/big.part.
+for part in archive/big.part.*; do gzip -c $part; done > archive/big.cpp.gz
+
+srcml archive/big.cpp -o archive/big.xml
+srcml archive/big.cpp.gz -o archive/big.cpp.xml
+check_file archive/big.cpp.xml archive/big.xml
+
+srcml archive/big.xml -o archive/big.out.cpp
+check_file archive/big.out.cpp archive/big.cpp
+
+rm -f archive/big.part.*
+rmfile archive/a.cpp
+rmfile archive/b.cpp
+rmfile archive/ab.cpp
+rmfile archive/ab.cpp.gz
+rmfile archive/ab.xml
+rmfile archive/ab.cpp.xml
+rmfile archive/big.cpp
+rmfile archive/big.cpp.gz
+rmfile archive/big.xml
+rmfile archive/big.cpp.xml
+rmfile archive/big.out.cpp
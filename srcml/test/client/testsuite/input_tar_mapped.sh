@@ -0,0 +1,67 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test that an uncompressed tar, which is read from memory, gives the same
+# srcML as a compressed tar and standard input, which are read by libarchive
+define output <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" url="units">
+
+	<unit revision="REVISION" language="C++" filename="archive/a.cpp" hash="1a2c5d67e6f651ae10b7673c53e8c502c97316d6"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+	</unit>
+
+	<unit revision="REVISION" language="C++" filename="archive/empty.cpp" hash="da39a3ee5e6b4b0d3255bfef95601890afd80709"/>
+
+	<unit revision="REVISION" language="C++" filename="archive/b.cpp" hash="520b48acbdb61e411641fd94359a82686d5591eb"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+	</unit>
+
+	</unit>
+	STDOUT
+
+xmlcheck "$output"
+
+# an empty member between two others
+createfile archive/a.cpp "a;\n"
+createfile archive/empty.cpp ""
+createfile archive/b.cpp "b;\n"
+tar -cf archive/units.tar archive/a.cpp archive/empty.cpp archive/b.cpp
+tar -czf archive/units.tar.gz archive/a.cpp archive/empty.cpp archive/b.cpp
+
+srcml --url=units archive/units.tar
+check "$output"
+
+srcml --url=units archive/units.tar -o archive/units.xml
+check archive/units.xml "$output"
+
+srcml --url=units archive/units.tar.gz
+check "$output"
+
+srcml -l C++ --url=units < archive/units.tar
+check "$output"
+
+# a member over many blocks of the archive
+big=
+for i in $(seq 1 5000); do
+    big+="c$i;\n"
+done
+createfile archive/big.cpp "$big"
+tar -cf archive/units.tar archive/a.cpp archive/big.cpp archive/empty.cpp archive/b.cpp
+tar -czf archive/units.tar.gz archive/a.cpp archive/big.cpp archive/empty.cpp archive/b.cpp
+
+srcml --url=units archive/units.tar -o archive/units.xml
+
+srcml --url=units archive/units.tar.gz
+check archive/units.xml
+
+srcml -l C++ --url=units < archive/units.tar
+check archive/units.xml
+
+rmfile archive/a.cpp
+rmfile archive/empty.cpp
+rmfile archive/b.cpp
+rmfile archive/big.cpp
+rmfile archive/units.tar
+rmfile archive/units.tar.gz
+rmfile archive/units.xml
@@ -59,3 +59,32 @@ check "$sxmlfile"
 
 srcml --archive sub/a.cpp -o sub/a.cpp.xml.gz && gunzip -c sub/a.cpp.xml.gz
 check "$sxmlfile"
+
+# compression in parallel blocks, and on a single stream
+srcml --compression-threads 4 sub/a.cpp -o sub/a.cpp.xml.gz && gunzip -c sub/a.cpp.xml.gz
+check "$xmlfile"
+
+srcml --compression-threads 1 sub/a.cpp -o sub/a.cpp.xml.gz && gunzip -c sub/a.cpp.xml.gz
+check "$xmlfile"
+
+srcml --compression-threads 4 --archive sub/a.cpp -o sub/a.cpp.xml.gz && gunzip -c sub/a.cpp.xml.gz
+check "$sxmlfile"
+
+# compression in parallel blocks of output larger than a block
+head -c 2000000 /dev/urandom | od -An -v -tx4 | sed 's/^ */x/; s/ /+x/g; s/$/;/' > sub/big.cpp
+
+srcml sub/big.cpp -o sub/big.xml
+srcml --compression-threads 4 sub/big.cpp -o sub/big.xml.gz
+gunzip -c sub/big.xml.gz > sub/big.gz.xml
+check_file sub/big.gz.xml sub/big.xml
+
+srcml --compression-threads 4 sub/big.xml -o sub/big.cpp.gz
+gunzip -c sub/big.cpp.gz > sub/big.out.cpp
+check_file sub/big.out.cpp sub/big.cpp
+
+rmfile sub/big.cpp
+rmfile sub/big.xml
+rmfile sub/big.xml.gz
+rmfile sub/big.gz.xml
+rmfile sub/big.cpp.gz
+rmfile sub/big.out.cpp
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test parse limits
+define src <<< "a = b < c;"
+
+define limited <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" xmlns:err="http://www.srcML.org/srcML/error" revision="REVISION" language="C++" filename="sub/a.cpp" err:parse="size">a = b &lt; c;
+	</unit>
+	STDOUT
+
+define unlimited <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="sub/a.cpp"><expr_stmt><expr><name>a</name> <operator>=</operator> <name>b</name> <operator>&lt;</operator> <name>c</name></expr>;</expr_stmt>
+	</unit>
+	STDOUT
+
+xmlcheck "$limited"
+xmlcheck "$unlimited"
+
+createfile sub/a.cpp "a = b < c;\n"
+
+# over the size limit is stored as text
+srcml --parse-max-size 4 sub/a.cpp
+check "$limited"
+
+srcml --parse-max-size 4 sub/a.cpp -o sub/a.cpp.xml
+check sub/a.cpp.xml "$limited"
+
+# under the limits is parsed
+srcml --parse-max-size 1000 sub/a.cpp
+check "$unlimited"
+
+srcml --parse-timeout 60000 sub/a.cpp
+check "$unlimited"
+
+# source is the same either way
+createfile sub/a.cpp.xml "$limited"
+srcml sub/a.cpp.xml
+check "$src"
@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test position of nested, multi-line elements after non-ASCII text, in a unit
+# large enough that the output is flushed before the end of the elements is parsed
+define header <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" xmlns:pos="http://www.srcML.org/srcML/position" revision="REVISION" language="C++" filename="sub/a.cpp" pos:tabs="8">
+	STDOUT
+
+define first <<- 'STDOUT'
+	<expr_stmt pos:start="1:1" pos:end="1:11"><expr pos:start="1:1" pos:end="1:10"><name pos:start="1:1" pos:end="1:1">s</name> <operator pos:start="1:3" pos:end="1:3">=</operator> <literal type="string" pos:start="1:5" pos:end="1:10">"çé"</literal></expr>;</expr_stmt>
+	STDOUT
+
+# the string has 2 characters in 4 bytes, and columns are in bytes
+src='s = "çé";\nx =\n'
+
+# one expression over lines 2 to 202
+terms=
+for i in $(seq 1 200); do
+    line=$((i + 2))
+    end=$((${#i} + 1))
+    if [ $i -lt 200 ]; then
+        src+="a$i +\n"
+        terms+="<name pos:start=\"$line:1\" pos:end=\"$line:$end\">a$i</name> <operator pos:start=\"$line:$((end + 2))\" pos:end=\"$line:$((end + 2))\">+</operator>\n"
+    else
+        src+="a$i;\n"
+        terms+="<name pos:start=\"$line:1\" pos:end=\"$line:$end\">a$i</name>"
+    fi
+done
+
+second="<expr_stmt pos:start=\"2:1\" pos:end=\"202:5\"><expr pos:start=\"2:1\" pos:end=\"202:4\"><name pos:start=\"2:1\" pos:end=\"2:1\">x</name> <operator pos:start=\"2:3\" pos:end=\"2:3\">=</operator>\n$terms</expr>;</expr_stmt>\n"
+
+# the unit start tag is followed by the first statement on the same line
+srcml="${header%$'\n'}$first$second</unit>\n"
+
+xmlcheck "$(echo -en "$srcml")"
+createfile sub/a.cpp "$src"
+
+srcml --position sub/a.cpp
+check "$srcml"
+
+srcml sub/a.cpp --position -o sub/a.cpp.xml
+check sub/a.cpp.xml "$srcml"
+
+rmfile sub/a.cpp
+rmfile sub/a.cpp.xml
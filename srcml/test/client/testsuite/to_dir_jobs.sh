@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# test framework
+source $(dirname "$0")/framework_test.sh
+
+# test --to-dir with units written concurrently, where a repeated filename keeps the last unit
+define srcmla <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="archive/a.cpp" hash="bcadfd6aacc62927bdb3e0a9f04b9aa11c192b6d"><expr_stmt><expr><name>e</name></expr>;</expr_stmt></unit>
+	STDOUT
+
+define srcmlb <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="archive/b.cpp" hash="9a1e1d3d0e27715d29bcfbf72b891b3ece985b36"><expr_stmt><expr><name>b</name></expr>;</expr_stmt></unit>
+	STDOUT
+
+define srcmlc <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="archive/c.cpp" hash="e8622977d7b817a78d262b7a3d222bee631740f8"><expr_stmt><expr><name>c</name></expr>;</expr_stmt></unit>
+	STDOUT
+
+define srcmld <<- 'STDOUT'
+	<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+	<unit xmlns="http://www.srcML.org/srcML/src" revision="REVISION" language="C++" filename="archive/d.cpp" hash="685c9c740565c4307176282f6dea4420999fff30"><expr_stmt><expr><name>d</name></expr>;</expr_stmt></unit>
+	STDOUT
+
+xmlcheck "$srcmla"
+xmlcheck "$srcmlb"
+xmlcheck "$srcmlc"
+xmlcheck "$srcmld"
+
+# archive/a.cpp is in the tar twice, and the second one is last
+createfile archive/a.cpp "a;"
+createfile archive/b.cpp "b;"
+createfile archive/c.cpp "c;"
+createfile archive/d.cpp "d;"
+tar -cf archive/units.tar archive/a.cpp archive/b.cpp archive/c.cpp archive/d.cpp
+createfile archive/a.cpp "e;"
+tar -rf archive/units.tar archive/a.cpp
+
+rmfile archive/a.cpp
+rmfile archive/b.cpp
+rmfile archive/c.cpp
+rmfile archive/d.cpp
+
+srcml --to-dir out -j 4 archive/units.tar
+check out/archive/a.cpp.xml "$srcmla"
+check out/archive/b.cpp.xml "$srcmlb"
+check out/archive/c.cpp.xml "$srcmlc"
+check out/archive/d.cpp.xml "$srcmld"
+
+rm -fr out
+
+srcml archive/units.tar -j 8 --to-dir out
+check out/archive/a.cpp.xml "$srcmla"
+check out/archive/b.cpp.xml "$srcmlb"
+check out/archive/c.cpp.xml "$srcmlc"
+check out/archive/d.cpp.xml "$srcmld"
+
+rm -fr out
+
+# a single thread writes the same files
+srcml --to-dir out -j 1 archive/units.tar
+check out/archive/a.cpp.xml "$srcmla"
+check out/archive/b.cpp.xml "$srcmlb"
+check out/archive/c.cpp.xml "$srcmlc"
+check out/archive/d.cpp.xml "$srcmld"
+
+rm -fr out
+rmfile archive/units.tar
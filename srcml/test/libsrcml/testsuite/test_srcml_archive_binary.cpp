@@ -0,0 +1,259 @@
+/**
+ * @file test_srcml_archive_binary.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+
+  Test cases for binary srcML
+*/
+
+#include <srcml.h>
+
+#include <dassert.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+static void write_archive(srcml_archive* archive) {
+
+    const char* filenames[] = { "a.cpp", "b.cpp", "c.cpp" };
+    const char* sources[] = { "a;\n", "b;\nc;\n", "#if A\nd < 1 && \"&\";\n#endif\n" };
+
+    for (int i = 0; i < 3; ++i) {
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_filename(unit, filenames[i]);
+        srcml_unit_set_language(unit, "C++");
+        srcml_unit_parse_memory(unit, sources[i], strlen(sources[i]));
+        srcml_archive_write_unit(archive, unit);
+        srcml_unit_free(unit);
+    }
+}
+
+// copy the units of an archive to a new archive with the same setup
+static std::string copy_archive(const char* s, size_t size, bool binary) {
+
+    srcml_archive* iarchive = srcml_archive_create();
+    srcml_archive_read_open_memory(iarchive, s, size);
+
+    char* buffer = 0;
+    size_t buffer_size = 0;
+    srcml_archive* oarchive = srcml_archive_clone(iarchive);
+    if (binary)
+        srcml_archive_enable_binary(oarchive);
+    srcml_archive_write_open_memory(oarchive, &buffer, &buffer_size);
+
+    while (srcml_unit* unit = srcml_archive_read_unit(iarchive)) {
+        srcml_archive_write_unit(oarchive, unit);
+        srcml_unit_free(unit);
+    }
+
+    srcml_archive_close(iarchive);
+    srcml_archive_free(iarchive);
+    srcml_archive_close(oarchive);
+    srcml_archive_free(oarchive);
+
+    std::string result(buffer, buffer_size);
+    srcml_memory_free(buffer);
+
+    return result;
+}
+
+int main(int, char* argv[]) {
+
+    /*
+      srcml_archive_enable_binary
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_is_binary(archive), 0);
+        dassert(srcml_archive_enable_binary(archive), SRCML_STATUS_OK);
+        dassert(srcml_archive_is_binary(archive), 1);
+        dassert(srcml_archive_disable_binary(archive), SRCML_STATUS_OK);
+        dassert(srcml_archive_is_binary(archive), 0);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_enable_binary(0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_disable_binary(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    /*
+      binary srcML to and from XML
+    */
+
+    {
+        char* xml = 0;
+        size_t xml_size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_set_url(archive, "project");
+        srcml_archive_write_open_memory(archive, &xml, &xml_size);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        char* binary = 0;
+        size_t binary_size = 0;
+        archive = srcml_archive_create();
+        srcml_archive_set_url(archive, "project");
+        srcml_archive_enable_binary(archive);
+        srcml_archive_write_open_memory(archive, &binary, &binary_size);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        dassert(binary[0], '\0');
+        dassert(std::string(binary + 1, 7), "srcMLb1");
+
+        archive = srcml_archive_create();
+        dassert(srcml_archive_read_open_memory(archive, binary, binary_size), SRCML_STATUS_OK);
+        dassert(srcml_archive_is_binary(archive), 1);
+        dassert(srcml_archive_get_url(archive), std::string("project"));
+
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("a.cpp"));
+        dassert(srcml_unit_get_language(unit), std::string("C++"));
+        dassert(srcml_unit_get_loc(unit), 1);
+        srcml_unit_free(unit);
+
+        dassert(srcml_archive_skip_unit(archive), 1);
+
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("c.cpp"));
+        char* src = 0;
+        size_t src_size = 0;
+        srcml_unit_unparse_memory(unit, &src, &src_size);
+        dassert(std::string(src, src_size), "#if A\nd < 1 && \"&\";\n#endif\n");
+        srcml_memory_free(src);
+        srcml_unit_free(unit);
+
+        dassert(srcml_archive_read_unit(archive), 0);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // binary to XML is the same as XML written directly
+        dassert(copy_archive(binary, binary_size, false), std::string(xml, xml_size));
+
+        // XML to binary to XML is the same as XML to XML
+        std::string xml_binary = copy_archive(xml, xml_size, true);
+        dassert(copy_archive(xml_binary.c_str(), xml_binary.size(), false), copy_archive(xml, xml_size, false));
+
+        srcml_memory_free(xml);
+        srcml_memory_free(binary);
+    }
+
+    /*
+      truncated binary srcML
+    */
+
+    {
+        char* binary = 0;
+        size_t binary_size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_binary(archive);
+        srcml_archive_write_open_memory(archive, &binary, &binary_size);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, binary, binary_size);
+        int count = 0;
+        while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+            ++count;
+            srcml_unit_free(unit);
+        }
+        dassert(count, 3);
+        dassert(srcml_archive_error_number(archive), SRCML_STATUS_OK);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        // in the middle of the last unit record, and without the end record
+        for (size_t cut : { (size_t) 5, (size_t) 1 }) {
+
+            archive = srcml_archive_create();
+            srcml_archive_read_open_memory(archive, binary, binary_size - cut);
+            count = 0;
+            while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+                ++count;
+                srcml_unit_free(unit);
+            }
+            dassert(count, cut == 1 ? 3 : 2);
+            dassert(srcml_archive_error_number(archive), SRCML_STATUS_INVALID_INPUT);
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+        }
+
+        srcml_memory_free(binary);
+    }
+
+    /*
+      binary srcML with an xml encoding
+    */
+
+    {
+        FILE* file = tmpfile();
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_set_xml_encoding(archive, "ISO-8859-1");
+        srcml_archive_enable_binary(archive);
+        dassert(srcml_archive_write_open_FILE(archive, file), SRCML_STATUS_OK);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        fflush(file);
+        rewind(file);
+
+        archive = srcml_archive_create();
+        srcml_archive_set_xml_encoding(archive, "ISO-8859-1");
+        dassert(srcml_archive_read_open_FILE(archive, file), SRCML_STATUS_OK);
+        dassert(srcml_archive_is_binary(archive), 1);
+        dassert(srcml_archive_get_xml_encoding(archive), std::string("ISO-8859-1"));
+        int count = 0;
+        while (srcml_unit* unit = srcml_archive_read_unit(archive)) {
+            ++count;
+            srcml_unit_free(unit);
+        }
+        dassert(count, 3);
+        dassert(srcml_archive_error_number(archive), SRCML_STATUS_OK);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        fclose(file);
+    }
+
+    {
+        FILE* file = tmpfile();
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_set_xml_encoding(archive, "ISO-8859-1");
+        srcml_archive_write_open_FILE(archive, file);
+        dassert(srcml_archive_enable_binary(archive), SRCML_STATUS_INVALID_IO_OPERATION);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        fclose(file);
+    }
+
+    srcml_cleanup_globals();
+
+    return 0;
+}
@@ -59,6 +59,48 @@ int main(int argc, char* argv[]) {
         srcml_archive_free(new_archive);
     }
 
+    // changes after a clone only apply to the changed archive
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_register_macro(archive, "MACRO", "src:macro");
+
+        srcml_archive* new_archive = srcml_archive_clone(archive);
+        size_t namespace_size = srcml_archive_get_namespace_size(archive);
+
+        srcml_archive_register_namespace(new_archive, "foo", "bar");
+        srcml_archive_register_macro(new_archive, "OTHER", "src:name");
+        srcml_archive_register_file_extension(new_archive, "foo", "C++");
+        srcml_append_transform_xpath(new_archive, "//src:unit");
+
+        dassert(srcml_archive_get_namespace_size(archive), namespace_size);
+        dassert(srcml_archive_get_namespace_size(new_archive), namespace_size + 1);
+        dassert(srcml_archive_get_macro_list_size(archive), 1);
+        dassert(srcml_archive_get_macro_list_size(new_archive), 2);
+        dassert(srcml_archive_check_extension(archive, "a.foo"), 0);
+        dassert(srcml_archive_check_extension(new_archive, "a.foo"), std::string("C++"));
+
+        srcml_archive_register_macro(archive, "MACRO", "src:name");
+        dassert(srcml_archive_get_macro_token_type(new_archive, "MACRO"), std::string("src:macro"));
+
+        srcml_archive_free(archive);
+        srcml_archive_free(new_archive);
+    }
+
+    // change of the prefix of an existing namespace on a clone
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive* new_archive = srcml_archive_clone(archive);
+
+        srcml_archive_register_namespace(new_archive, "s", "http://www.srcML.org/srcML/src");
+
+        dassert(srcml_archive_get_prefix_from_uri(new_archive, "http://www.srcML.org/srcML/src"), std::string("s"));
+        dassert(srcml_archive_get_prefix_from_uri(archive, "http://www.srcML.org/srcML/src"), std::string(""));
+        dassert(srcml_archive_get_namespace_size(new_archive), srcml_archive_get_namespace_size(archive));
+
+        srcml_archive_free(archive);
+        srcml_archive_free(new_archive);
+    }
+
     {
         dassert(srcml_archive_clone(0), 0);
     }
@@ -27,6 +27,28 @@
 
 #include <dassert.hpp>
 
+#include <cstring>
+#include <sstream>
+#include <string>
+
+// count and amount of a stage in a statistics report
+static std::pair<unsigned long long, unsigned long long> stage_counts(const std::string& report, const std::string& stage) {
+
+    std::pair<unsigned long long, unsigned long long> counts;
+    std::istringstream lines(report);
+    for (std::string line; std::getline(lines, line);) {
+
+        std::istringstream fields(line);
+        std::string name;
+        if (fields >> name && name == stage) {
+            fields >> counts.first >> counts.second;
+            break;
+        }
+    }
+
+    return counts;
+}
+
 int main(int, char* argv[]) {
 
     /*
@@ -339,5 +361,67 @@ int main(int, char* argv[]) {
         dassert(srcml_archive_get_srcdiff_revision(0), SRCDIFF_REVISION_INVALID);
     }
 
+    /*
+      srcml_archive_get_statistics
+    */
+
+    // the report is empty when libsrcml is built without statistics
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_get_statistics(archive) != 0, true);
+        std::string report = srcml_archive_get_statistics(archive);
+#ifdef NO_SRCML_STATISTICS
+        dassert(report, "");
+#else
+        dassert(report.find("parse") != std::string::npos, true);
+#endif
+        srcml_archive_free(archive);
+    }
+
+    // counts of the stages on a known input
+    {
+        char* s = 0;
+        size_t size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_write_open_memory(archive, &s, &size);
+
+        const char* sources[] = { "a;\n", "int b;\nc();\n" };
+        for (const char* source : sources) {
+            srcml_unit* unit = srcml_unit_create(archive);
+            srcml_unit_set_language(unit, "C++");
+            srcml_unit_parse_memory(unit, source, strlen(source));
+            srcml_archive_write_unit(archive, unit);
+            srcml_unit_free(unit);
+        }
+
+        std::string report = srcml_archive_get_statistics(archive);
+#ifdef NO_SRCML_STATISTICS
+        dassert(report, "");
+#else
+        dassert(stage_counts(report, "parse").first, 2);
+        dassert(stage_counts(report, "parse").second, 15);
+        dassert(stage_counts(report, "input").second, 15);
+        dassert(stage_counts(report, "output").first, 2);
+        dassert(stage_counts(report, "lex").second > 0, true);
+        dassert(stage_counts(report, "guess").first > 0, true);
+
+        // each guess rewinds to where it started
+        dassert(stage_counts(report, "rewind").first >= stage_counts(report, "guess").first, true);
+
+        // parsing to memory finalizes and extracts the srcML of each unit
+        dassert(stage_counts(report, "finalize").first, 2);
+        dassert(stage_counts(report, "extract").first, 2);
+        dassert(stage_counts(report, "transform").first, 0);
+#endif
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        srcml_memory_free(s);
+    }
+
+    {
+        dassert(srcml_archive_get_statistics(0), 0);
+    }
+
     return 0;
 }
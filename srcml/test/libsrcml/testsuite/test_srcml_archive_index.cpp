@@ -0,0 +1,217 @@
+/**
+ * @file test_srcml_archive_index.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+
+  Test cases for the unit index, srcml_archive_seek_unit and srcml_archive_get_unit_count
+*/
+
+#include <srcml.h>
+
+#include <dassert.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+
+static void write_archive(srcml_archive* archive) {
+
+    const char* filenames[] = { "a.cpp", "b.cpp", "c.cpp" };
+    const char* sources[] = { "a;\n", "b;\nc;\n", "d;\n" };
+
+    for (int i = 0; i < 3; ++i) {
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_filename(unit, filenames[i]);
+        srcml_unit_set_language(unit, "C++");
+        srcml_unit_parse_memory(unit, sources[i], strlen(sources[i]));
+        srcml_archive_write_unit(archive, unit);
+        srcml_unit_free(unit);
+    }
+}
+
+int main(int, char* argv[]) {
+
+    /*
+      srcml_archive_enable_index
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_has_index(archive), 0);
+        dassert(srcml_archive_enable_index(archive), SRCML_STATUS_OK);
+        dassert(srcml_archive_has_index(archive), 1);
+        dassert(srcml_archive_disable_index(archive), SRCML_STATUS_OK);
+        dassert(srcml_archive_has_index(archive), 0);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_enable_index(0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_disable_index(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    /*
+      unit index in memory
+    */
+
+    {
+        char* s = 0;
+        size_t size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_index(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        std::string srcml(s, size);
+        dassert(srcml.find("</unit>\n<?srcml-index ") != std::string::npos, true);
+        dassert(srcml.substr(srcml.size() - 3), "?>\n");
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, s, size);
+        dassert(srcml_archive_has_index(archive), 1);
+        dassert(srcml_archive_get_unit_count(archive), 3);
+
+        dassert(srcml_archive_seek_unit(archive, 2), SRCML_STATUS_OK);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("b.cpp"));
+        dassert(srcml_unit_get_loc(unit), 2);
+        srcml_unit_free(unit);
+
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("c.cpp"));
+        srcml_unit_free(unit);
+
+        dassert(srcml_archive_read_unit(archive), 0);
+
+        dassert(srcml_archive_seek_unit_filename(archive, "a.cpp"), SRCML_STATUS_OK);
+        unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("a.cpp"));
+        srcml_unit_free(unit);
+
+        dassert(srcml_archive_seek_unit(archive, 0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_seek_unit(archive, 4), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_seek_unit_filename(archive, "d.cpp"), SRCML_STATUS_INVALID_ARGUMENT);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        free(s);
+    }
+
+    /*
+      unit index in a file
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_index(archive);
+        srcml_archive_write_open_filename(archive, "index.xml");
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "index.xml");
+        dassert(srcml_archive_get_unit_count(archive), 3);
+
+        dassert(srcml_archive_seek_unit(archive, 3), SRCML_STATUS_OK);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("c.cpp"));
+        srcml_unit_free(unit);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    /*
+      unit index in a file with an xml encoding
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_index(archive);
+        srcml_archive_set_xml_encoding(archive, "ISO-8859-1");
+        srcml_archive_write_open_filename(archive, "index.xml");
+
+        const char* filenames[] = { "a.cpp", "b.cpp", "c.cpp" };
+        const char* sources[] = { "/* \xc3\xbe\xc3\xbf */\n", "/* \xe2\x9c\x93 */\nb;\n", "c;\n" };
+        for (int i = 0; i < 3; ++i) {
+            srcml_unit* unit = srcml_unit_create(archive);
+            srcml_unit_set_filename(unit, filenames[i]);
+            srcml_unit_set_language(unit, "C++");
+            srcml_unit_set_src_encoding(unit, "UTF-8");
+            srcml_unit_parse_memory(unit, sources[i], strlen(sources[i]));
+            srcml_archive_write_unit(archive, unit);
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_filename(archive, "index.xml");
+        dassert(srcml_archive_get_unit_count(archive), 3);
+
+        for (int i = 3; i > 0; --i) {
+            dassert(srcml_archive_seek_unit(archive, i), SRCML_STATUS_OK);
+            srcml_unit* unit = srcml_archive_read_unit(archive);
+            dassert(srcml_unit_get_filename(unit), std::string(filenames[i - 1]));
+            srcml_unit_free(unit);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    /*
+      archive without a unit index
+    */
+
+    {
+        char* s = 0;
+        size_t size = 0;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_write_open_memory(archive, &s, &size);
+        write_archive(archive);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+
+        archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, s, size);
+        dassert(srcml_archive_has_index(archive), 0);
+        dassert(srcml_archive_get_unit_count(archive), -1);
+        dassert(srcml_archive_seek_unit(archive, 2), SRCML_STATUS_INVALID_IO_OPERATION);
+        dassert(srcml_archive_seek_unit_filename(archive, "b.cpp"), SRCML_STATUS_INVALID_IO_OPERATION);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        free(s);
+    }
+
+    {
+        dassert(srcml_archive_get_unit_count(0), -1);
+        dassert(srcml_archive_seek_unit(0, 1), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_seek_unit_filename(0, "a.cpp"), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
+    srcml_cleanup_globals();
+
+    return 0;
+}
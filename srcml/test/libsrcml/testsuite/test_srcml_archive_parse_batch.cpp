@@ -0,0 +1,146 @@
+/**
+ * @file test_srcml_archive_parse_batch.cpp
+ *
+ * @copyright Copyright (C) 2019 srcML, LLC. (www.srcML.org)
+ *
+ * The srcML Toolkit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * The srcML Toolkit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the srcML Toolkit; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+
+  Test cases for srcml_archive_parse_batch
+*/
+
+#include <srcml.h>
+
+#include <macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include <dassert.hpp>
+
+void collect_callback(void* context, size_t index, struct srcml_unit* unit, int status) {
+
+    auto units = (std::vector<std::string>*) context;
+    (*units)[index] = status == SRCML_STATUS_OK ? srcml_unit_get_srcml_outer(unit) : "";
+    srcml_unit_free(unit);
+}
+
+int main(int, char* argv[]) {
+
+    const std::string src = "a;\n";
+    const std::string srcml_c =
+R"(<unit revision=")" SRCML_VERSION_STRING R"(" language="C" filename="a.c"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>)";
+    const std::string srcml_cpp =
+R"(<unit revision=")" SRCML_VERSION_STRING R"(" language="C++" filename="a.h"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>)";
+
+    std::vector<srcml_parse_input> inputs;
+    for (int i = 0; i < 50; ++i) {
+        inputs.push_back({ src.c_str(), src.size(), "a.c", nullptr });
+        inputs.push_back({ src.c_str(), src.size(), "a.h", "C++" });
+    }
+
+    /*
+      srcml_archive_parse_batch
+    */
+    {
+        char* s;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_disable_hash(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+
+        std::vector<srcml_unit*> units(inputs.size());
+        dassert(srcml_archive_parse_batch(archive, inputs.data(), inputs.size(), 4, units.data()), SRCML_STATUS_OK);
+
+        for (size_t i = 0; i < units.size(); ++i) {
+            dassert(srcml_unit_get_srcml_outer(units[i]), (i % 2 ? srcml_cpp : srcml_c));
+            srcml_unit_free(units[i]);
+        }
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        srcml_memory_free(s);
+    }
+
+    {
+        char* s;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_disable_hash(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+
+        std::vector<srcml_parse_input> unknown = { { src.c_str(), src.size(), "a.c", nullptr }, { src.c_str(), src.size(), "a.foo", nullptr } };
+        std::vector<srcml_unit*> units(unknown.size());
+        dassert(srcml_archive_parse_batch(archive, unknown.data(), unknown.size(), 0, units.data()), SRCML_STATUS_UNSET_LANGUAGE);
+        dassert(srcml_unit_get_srcml_outer(units[0]), srcml_c);
+        dassert(units[1], 0);
+
+        srcml_unit_free(units[0]);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        srcml_memory_free(s);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_unit* unit = 0;
+
+        dassert(srcml_archive_parse_batch(0, inputs.data(), inputs.size(), 4, &unit), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_parse_batch(archive, 0, 1, 4, &unit), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_parse_batch(archive, inputs.data(), 1, 4, 0), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_parse_batch(archive, inputs.data(), 1, -1, &unit), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_parse_batch(archive, 0, 0, 4, &unit), SRCML_STATUS_OK);
+
+        srcml_archive_free(archive);
+    }
+
+    /*
+      srcml_archive_parse_batch_callback
+    */
+    {
+        char* s;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_disable_hash(archive);
+        srcml_archive_write_open_memory(archive, &s, &size);
+
+        std::vector<std::string> units(inputs.size());
+        dassert(srcml_archive_parse_batch_callback(archive, inputs.data(), inputs.size(), 3, &units, collect_callback), SRCML_STATUS_OK);
+
+        for (size_t i = 0; i < units.size(); ++i)
+            dassert(units[i], (i % 2 ? srcml_cpp : srcml_c));
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        srcml_memory_free(s);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        std::vector<std::string> units(inputs.size());
+
+        dassert(srcml_archive_parse_batch_callback(archive, inputs.data(), inputs.size(), 3, &units, 0), SRCML_STATUS_INVALID_ARGUMENT);
+
+        srcml_archive_free(archive);
+    }
+
+    srcml_cleanup_globals();
+
+    return 0;
+}
@@ -196,6 +196,85 @@ int main(int, char* argv[]) {
         free(s);
     }
 
+    {
+        // asynchronous writes have the same output as synchronous writes
+        std::string outputs[2];
+        for (int queue_size = 0; queue_size < 2; ++queue_size) {
+
+            char* s = 0;
+            size_t size;
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_disable_hash(archive);
+            dassert(srcml_archive_set_write_queue_size(archive, (size_t) queue_size), SRCML_STATUS_OK);
+            dassert(srcml_archive_get_write_queue_size(archive), (size_t) queue_size);
+            srcml_archive_write_open_memory(archive, &s, &size);
+
+            for (int i = 0; i < 10; ++i) {
+                srcml_unit* unit = srcml_unit_create(archive);
+                srcml_unit_set_filename(unit, (std::to_string(i) + ".cpp").c_str());
+                srcml_unit_set_language(unit, "C++");
+                srcml_unit_parse_memory(unit, "a;\n", 3);
+
+                dassert(srcml_archive_write_unit(archive, unit), SRCML_STATUS_OK);
+
+                srcml_unit_free(unit);
+            }
+
+            dassert(srcml_archive_write_flush(archive), SRCML_STATUS_OK);
+
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+
+            outputs[queue_size] = std::string(s, size);
+
+            free(s);
+        }
+
+        dassert(outputs[1], outputs[0]);
+    }
+
+    {
+        // changes to the archive after a write do not apply to the queued unit
+        std::string outputs[2];
+        for (int queue_size = 0; queue_size < 2; ++queue_size) {
+
+            char* s = 0;
+            size_t size;
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_disable_hash(archive);
+            srcml_archive_set_write_queue_size(archive, (size_t) queue_size);
+            srcml_archive_write_open_memory(archive, &s, &size);
+
+            const char* prefixes[] = { "", "s", "t" };
+            for (const char* prefix : prefixes) {
+                srcml_unit* unit = srcml_unit_create(archive);
+                srcml_unit_set_language(unit, "C++");
+                srcml_unit_parse_memory(unit, "a;\n", 3);
+
+                dassert(srcml_archive_write_unit(archive, unit), SRCML_STATUS_OK);
+                srcml_archive_register_namespace(archive, prefix, "http://www.srcML.org/srcML/src");
+
+                srcml_unit_free(unit);
+            }
+
+            srcml_archive_close(archive);
+            dassert(srcml_archive_error_number(archive), SRCML_STATUS_OK);
+            srcml_archive_free(archive);
+
+            outputs[queue_size] = std::string(s, size);
+
+            free(s);
+        }
+
+        dassert(outputs[1], outputs[0]);
+    }
+
+    {
+        dassert(srcml_archive_set_write_queue_size(0, 1), SRCML_STATUS_INVALID_ARGUMENT);
+        dassert(srcml_archive_get_write_queue_size(0), 0);
+        dassert(srcml_archive_write_flush(0), SRCML_STATUS_INVALID_ARGUMENT);
+    }
+
     {
         char* s = 0;
         size_t size;
@@ -317,6 +317,85 @@ int main(int, char* argv[]) {
         dassert(srcml_archive_read_unit(0), 0);
     }
 
+    /*
+      srcml_archive_read_unit_header
+    */
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_two.c_str(), srcml_two.size());
+        srcml_unit* unit = srcml_archive_read_unit_header(archive);
+        dassert(srcml_unit_get_language(unit), std::string("C"));
+        dassert(srcml_unit_get_filename(unit), std::string("project.c"));
+        dassert(srcml_unit_get_loc(unit), 1);
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit_header(archive);
+        dassert(srcml_unit_get_language(unit), std::string("C"));
+        dassert(srcml_unit_get_filename(unit), std::string("project.c"));
+        srcml_unit_free(unit);
+        unit = srcml_archive_read_unit_header(archive);
+        dassert(unit, 0);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    // header-only reads alternating with full reads
+    {
+        std::string srcml_four = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<unit xmlns=\"http://www.srcML.org/srcML/src\">\n\n";
+        for (int i = 0; i < 4; ++i)
+            srcml_four += (i % 2 ? srcml_b_two : srcml_a) + "\n\n";
+        srcml_four += "</unit>\n";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, srcml_four.c_str(), srcml_four.size());
+        for (int i = 0; i < 4; ++i) {
+            srcml_unit* unit = i % 2 ? srcml_archive_read_unit(archive) : srcml_archive_read_unit_header(archive);
+            dassert(srcml_unit_get_filename(unit), std::string("project.c"));
+            if (i % 2)
+                dassert(srcml_unit_get_srcml_outer(unit), srcml_b_two);
+            srcml_unit_free(unit);
+        }
+        dassert(srcml_archive_read_unit(archive), 0);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    // ill-formed srcML ends the input with an error
+    {
+        const std::string illformed = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<unit xmlns="http://www.srcML.org/srcML/src">
+<unit language="C" filename="a.c"><expr_stmt><expr><name>a</name></expr>;</expr_stmt>
+</unit>
+<unit language="C" filename="b.c"><expr_stmt><expr><name>b</name></expr>;</expr_stmt>
+</unit
+)";
+
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, illformed.c_str(), illformed.size());
+        dassert(srcml_archive_error_number(archive), SRCML_STATUS_OK);
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        dassert(srcml_unit_get_filename(unit), std::string("a.c"));
+        srcml_unit_free(unit);
+        dassert(srcml_archive_read_unit(archive), 0);
+        dassert(srcml_archive_error_number(archive), SRCML_STATUS_INVALID_INPUT);
+        dassert(std::string(srcml_archive_error_string(archive)).empty(), false);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        dassert(srcml_archive_read_unit_header(archive), 0);
+        srcml_archive_free(archive);
+    }
+
+    {
+        dassert(srcml_archive_read_unit_header(0), 0);
+    }
+
     srcml_cleanup_globals();
 
     return 0;
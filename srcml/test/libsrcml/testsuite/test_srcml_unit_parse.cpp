@@ -1628,6 +1628,68 @@ R"(<unit revision=")" SRCML_VERSION_STRING R"(" language="C" src-encoding="UTF-8
         srcml_archive_free(archive);
     }
 
+    /*
+      parse size limit
+    */
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_set_parse_size_limit(archive, 2);
+        srcml_archive_write_open_filename(archive, "project.xml");
+
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C");
+        dassert(srcml_unit_parse_memory(unit, src.c_str(), src.size()), SRCML_STATUS_OK);
+        dassert(std::string(srcml_unit_get_srcml_outer(unit)).find("parse=\"size\"") != std::string::npos, true);
+        dassert(srcml_unit_get_srcml_inner(unit), src);
+        srcml_unit_free(unit);
+
+        unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C");
+        dassert(srcml_unit_parse_filename(unit, "project.c"), SRCML_STATUS_OK);
+        dassert(std::string(srcml_unit_get_srcml_outer(unit)).find("parse=\"size\"") != std::string::npos, true);
+        dassert(srcml_unit_get_srcml_inner(unit), src);
+        srcml_unit_free(unit);
+
+        unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C");
+        FILE* file = fopen("project.c", "r");
+        dassert(srcml_unit_parse_FILE(unit, file), SRCML_STATUS_OK);
+        fclose(file);
+        dassert(std::string(srcml_unit_get_srcml_outer(unit)).find("parse=\"size\"") != std::string::npos, true);
+        dassert(srcml_unit_get_srcml_inner(unit), src);
+        srcml_unit_free(unit);
+
+        // size is not known before the parse
+        unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C");
+        file = fopen("project.c", "r");
+        dassert(srcml_unit_parse_io(unit, file, read_callback, close_callback), SRCML_STATUS_OK);
+        fclose(file);
+        dassert(std::string(srcml_unit_get_srcml_outer(unit)).find("parse=\"size\"") != std::string::npos, true);
+        dassert(srcml_unit_get_srcml_inner(unit), src);
+        srcml_unit_free(unit);
+
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
+    {
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_enable_solitary_unit(archive);
+        srcml_archive_disable_hash(archive);
+        srcml_archive_set_parse_size_limit(archive, src.size());
+        srcml_archive_write_open_filename(archive, "project.xml");
+        srcml_unit* unit = srcml_unit_create(archive);
+        srcml_unit_set_language(unit, "C");
+        srcml_unit_parse_memory(unit, src.c_str(), src.size());
+
+        dassert(srcml_unit_get_srcml_outer(unit), srcml);
+
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+    }
+
     UNLINK("project.c");
     UNLINK("project_bom.c");
     UNLINK("project.foo");
@@ -284,6 +284,28 @@ int main(int, char* argv[]) {
         srcml_memory_free(s);
     }
 
+    {
+        const std::string escape_srcml = R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>
+<src:unit xmlns:src="http://www.srcML.org/srcML/src" language="C"><src:expr_stmt><src:expr><src:name>a</src:name> &lt; <src:name>b</src:name> &amp;&amp; <src:literal type="string">"c&gt;"</src:literal></src:expr>;</src:expr_stmt><src:escape char="0xc"/>
+</src:unit>
+)";
+
+        char* s;
+        size_t size;
+        srcml_archive* archive = srcml_archive_create();
+        srcml_archive_read_open_memory(archive, escape_srcml.c_str(), escape_srcml.size());
+        srcml_unit* unit = srcml_archive_read_unit(archive);
+        srcml_unit_set_src_encoding(unit, "UTF-8");
+
+        dassert(srcml_unit_unparse_memory(unit, &s, &size), SRCML_STATUS_OK);
+        dassert(std::string(s, size), "a < b && \"c>\";\f\n");
+
+        srcml_unit_free(unit);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        srcml_memory_free(s);
+    }
+
     {
         char* s;
         size_t size;
@@ -933,6 +955,47 @@ int main(int, char* argv[]) {
         srcml_archive_free(archive);
     }
 
+    /*
+      srcml_unit_unparse with a converted end of line
+    */
+
+    // the output is converted in 16 KB blocks, so the first line ends just before, on, and just after a block boundary
+    for (size_t eol : { (size_t) SOURCE_OUTPUT_EOL_CR, (size_t) SOURCE_OUTPUT_EOL_CRLF }) {
+        for (size_t length = 16 * 1024 - 2; length <= 16 * 1024 + 1; ++length) {
+
+            std::string long_src(length, 'a');
+            long_src += '\n';
+            for (int i = 0; i < 4000; ++i)
+                long_src += "b;\n";
+
+            const std::string long_srcml = "<unit xmlns=\"http://www.srcML.org/srcML/src\" language=\"C++\">" + long_src + "</unit>\n";
+
+            std::string eol_src;
+            for (char c : long_src) {
+                if (c == '\n')
+                    eol_src += eol == SOURCE_OUTPUT_EOL_CR ? "\r" : "\r\n";
+                else
+                    eol_src += c;
+            }
+
+            srcml_archive* archive = srcml_archive_create();
+            srcml_archive_read_open_memory(archive, long_srcml.c_str(), long_srcml.size());
+            srcml_unit* unit = srcml_archive_read_unit(archive);
+            dassert(srcml_unit_set_eol(unit, eol), SRCML_STATUS_OK);
+
+            char* buffer = 0;
+            size_t size = 0;
+            dassert(srcml_unit_unparse_memory(unit, &buffer, &size), SRCML_STATUS_OK);
+            std::string unparsed(buffer, size);
+            dassert(unparsed, eol_src);
+
+            srcml_memory_free(buffer);
+            srcml_unit_free(unit);
+            srcml_archive_close(archive);
+            srcml_archive_free(archive);
+        }
+    }
+
     UNLINK("project.c");
     UNLINK("project.xml");
     UNLINK("project_utf8.cpp");